@@ -51,6 +51,8 @@ public:
 
     virtual ErrCode DestroySensorChannel(sptr<IRemoteObject> sensorClient) = 0;
 
+    virtual ErrCode SetSensorOption(uint32_t sensorId, int32_t option) = 0;
+
     enum {
         ENABLE_SENSOR = 0,
         DISABLE_SENSOR,
@@ -59,6 +61,7 @@ public:
         GET_SENSOR_LIST,
         TRANSFER_DATA_CHANNEL,
         DESTROY_SENSOR_CHANNEL,
+        SET_SENSOR_OPTION,
     };
 };
 }  // namespace Sensors
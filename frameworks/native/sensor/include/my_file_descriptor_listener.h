@@ -46,9 +46,25 @@ public:
 
     void SetChannel(SensorDataChannel* channel);
 
+    void Stop();
+
 private:
+    void OnSharedRingReadable(const std::shared_ptr<SensorSharedRing> &sharedRing);
+    void DrainSharedRing(const std::shared_ptr<SensorSharedRing> &sharedRing);
+    void OnCompactReadable(int32_t fileDescriptor);
+    int32_t ReceiveDatagrams(int32_t fileDescriptor, uint8_t *frames, size_t frameSize);
+    void ReportEvents(int32_t num);
+    static constexpr uint32_t RECEIVE_DATAGRAM_COUNT = 16;
     SensorDataChannel* channel_;
     struct TransferSensorEvents *receiveDataBuff_ = nullptr;
+    uint8_t *receiveFrameBuff_ = nullptr;
+    SensorEvent *reportEventBuff_ = nullptr;
+    struct mmsghdr receiveMsgs_[RECEIVE_DATAGRAM_COUNT] = {};
+    struct iovec receiveIovs_[RECEIVE_DATAGRAM_COUNT] = {};
+    uint64_t ringCursor_ = 0;
+    uint64_t ringLostCount_ = 0;
+    // Set when the channel is destroyed, read loops check it after every callback before reading again
+    std::atomic<bool> isStopped_ { false };
 };
 }  // namespace Sensors
 }  // namespace OHOS
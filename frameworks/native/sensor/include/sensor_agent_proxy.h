@@ -16,19 +16,83 @@
 #ifndef SENSOR_PROXY_H
 #define SENSOR_PROXY_H
 
+#include <atomic>
+#include <condition_variable>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #include "refbase.h"
 
 #include "sensor_agent_type.h"
 #include "sensor_data_channel.h"
+#include "sensor_event_ring.h"
 
 namespace OHOS {
 namespace Sensors {
 struct SensorNativeData;
 struct SensorIdList;
 typedef int32_t (*SensorDataCallback)(struct SensorNativeData *events, uint32_t num);
+struct alignas(CACHE_LINE_SIZE) SensorPullSlot {
+    std::atomic<uint64_t> sequence { 0 };
+    SensorSample sample;
+};
+/*
+ * Events kept for a pull subscriber, written by the receive thread only and read by whichever threads poll the
+ * subscriber. The cursors count every sample ever written and read, the slot of a sample is its cursor modulo the
+ * capacity, so the writer simply overwrites the oldest samples and readers notice what they missed. Like
+ * SensorSharedRing every slot carries the sequence it was written with, a reader racing the writer drops its copy
+ * instead of blocking it. The mutex is only taken by readers waiting for events and by the writer waking them.
+ */
+struct SensorPullBuffer {
+    std::unique_ptr<SensorPullSlot[]> slots;
+    uint64_t capacity = 0;
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> writeCursor { 0 };
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> readCursor { 0 };
+    std::atomic<uint64_t> lostCount { 0 };
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> waitingReaders { 0 };
+    std::mutex waitMutex;
+    std::condition_variable waitCondition;
+};
+// One in-process user of a sensor, batch subscribers get the events of a read in one call instead of one by one
+struct SensorSubscriber {
+    const SensorUser *user = nullptr;
+    RecordSensorBatchCallback batchCallback = nullptr;
+    int64_t samplingInterval = 0;
+    int64_t reportInterval = 0;
+    // Options apply to the stream shared by every user of the sensor, see HasOptionConflict
+    int32_t option = SENSOR_OPTION_DEFAULT;
+    bool isActive = false;
+    // Client side decimation state, only touched from the event runner thread
+    std::shared_ptr<int64_t> nextDueTimestamp;
+    std::shared_ptr<SensorPullBuffer> pullBuffer;
+};
+/*
+ * All users of one sensor share a single service subscription, enabled with the most demanding parameters of the
+ * active ones. Users asking for a longer sampling interval are decimated on the client.
+ */
+struct SensorSubscription {
+    std::vector<SensorSubscriber> subscribers;
+    bool isEnabled = false;
+    int64_t samplingInterval = 0;
+    int64_t reportInterval = 0;
+};
+// Active users of one sensor and the sampling interval of the stream they share
+struct SensorDispatchEntry {
+    int32_t sensorId = 0;
+    std::vector<SensorSubscriber> subscribers;
+    int64_t streamInterval = 0;
+};
+/*
+ * Immutable snapshot of the enabled sensors of g_subscribeMap, sorted by sensorId. HandleSensorData resolves every
+ * sensor of a read from one atomically loaded snapshot, a new one is swapped in whenever a subscription changes.
+ * The table only grows with the sensors in use, whatever sensorId a caller subscribes to.
+ */
+struct SensorDispatchTable {
+    std::vector<SensorDispatchEntry> sensors;
+};
 
 struct SensorAgentProxy : public OHOS::RefBase {
 public:
@@ -39,24 +103,47 @@ public:
     int32_t DeactivateSensor(int32_t sensorId, const SensorUser *user) const;
     int32_t SetBatch(int32_t sensorId, const SensorUser *user, int64_t samplingInterval, int64_t reportInterval) const;
     int32_t SubscribeSensor(int32_t sensorId, const SensorUser *user) const;
+    int32_t SubscribeSensorBatch(int32_t sensorId, const SensorBatchUser *user) const;
+    int32_t SubscribeSensorPull(int32_t sensorId, const SensorPullUser *user) const;
+    int32_t ReadSensorEvents(int32_t sensorId, const SensorUser *user, SensorSample *samples, int32_t maxCount,
+        int64_t timeoutNs) const;
+    int32_t GetLatestSensorEvent(int32_t sensorId, const SensorUser *user, SensorSample *sample) const;
     int32_t UnsubscribeSensor(int32_t sensorId, const SensorUser *user) const;
     int32_t SetMode(int32_t sensorId, const SensorUser *user, int32_t mode) const;
     int32_t SetOption(int32_t sensorId, const SensorUser *user, int32_t option) const;
+    int32_t SetReceiveThread(const SensorReceiveThreadAttr *attr) const;
     int32_t GetAllSensors(SensorInfo **sensorInfo, int32_t *count) const;
 
 private:
     int32_t CreateSensorDataChannel() const;
     int32_t DestroySensorDataChannel() const;
+    int32_t Subscribe(int32_t sensorId, const SensorSubscriber &subscriber) const;
+    static SensorSubscriber *FindUser(int32_t sensorId, const SensorUser *user);
+    static bool HasOptionConflict(int32_t sensorId, const SensorUser *user, int32_t option);
+    static int32_t UpdateSensorParams(int32_t sensorId);
+    static void PublishDispatchTable();
+    static const SensorDispatchEntry *FindDispatchEntry(const SensorDispatchTable &dispatchTable, int32_t sensorId);
+    static std::shared_ptr<SensorPullBuffer> FindPullBuffer(int32_t sensorId, const SensorUser *user);
+    static void WritePullEvents(SensorPullBuffer &pullBuffer, const SensorEvent *events, int32_t num);
+    static int32_t PullEvents(SensorPullBuffer &pullBuffer, SensorSample *samples, int32_t maxCount);
+    static void WaitForPullEvents(SensorPullBuffer &pullBuffer, int64_t timeoutNs);
+    static void WaitForDispatch();
+    static SensorEvent *GatherSensorEvents(SensorEvent *events, int32_t num, int32_t &count);
+    static void DispatchEvents(SensorEvent *events, int32_t num, const SensorSubscriber &subscriber,
+        int64_t streamInterval);
     static void HandleSensorData(SensorEvent *events, int32_t num, void *data);
     static OHOS::sptr<SensorAgentProxy> sensorObj_;
     static std::mutex subscribeMutex_;
     static std::mutex chanelMutex_;
     OHOS::sptr<OHOS::Sensors::SensorDataChannel> dataChannel_;
     static bool g_isChannelCreated;
-    static int64_t g_samplingInterval;
-    static int64_t g_reportInterval;
-    static std::map<int32_t, const SensorUser *> g_subscribeMap;
-    static std::map<int32_t, const SensorUser *> g_unsubscribeMap;
+    static std::map<int32_t, SensorSubscription> g_subscribeMap;
+    // Scratch space of HandleSensorData, only touched from the event runner thread
+    static std::vector<SensorEvent> g_batchEvents;
+    static std::vector<SensorEvent> g_dueEvents;
+    static std::vector<int32_t> g_batchedSensors;
+    static std::shared_ptr<const SensorDispatchTable> g_dispatchTable;
+    static std::atomic<uint64_t> g_dispatchSequence;
 };
 }  // namespace Sensors
 }  // namespace OHOS
@@ -16,6 +16,7 @@
 #ifndef SENSOR_DATA_CHANNEL_H
 #define SENSOR_DATA_CHANNEL_H
 
+#include <atomic>
 #include <memory>
 #include <thread>
 
@@ -26,6 +27,8 @@
 namespace OHOS {
 namespace Sensors {
 typedef void (*DataChannelCB)(struct SensorEvent *events, int32_t num, void *data);
+class MyFileDescriptorListener;
+struct ReceiveThreadContext;
 class SensorDataChannel : public SensorBasicDataChannel {
 public:
     SensorDataChannel() = default;
@@ -36,6 +39,8 @@ public:
     bool IsThreadExit();
     bool IsThreadStart();
     int32_t RestoreSensorDataChannel();
+    void SetSharedRingCapacity(uint32_t capacity);
+    void SetReceiveThread(const SensorReceiveThreadAttr *attr);
     int32_t test = 10;
     DataChannelCB dataCB_ = nullptr;
     void *privateData_ = nullptr;
@@ -43,7 +48,19 @@ public:
 private:
     static void threadProcessTask(SensorDataChannel *sensorChannel);
     int32_t InnerSensorDataChannel();
+    void InitSharedRing();
+    int32_t AddSharedRingListener(const std::shared_ptr<AppExecFwk::FileDescriptorListener> &listener);
+    int32_t StartReceiveThread(const std::shared_ptr<MyFileDescriptorListener> &listener);
+    void StopReceiveThread();
+    static void ReceiveThreadTask(std::shared_ptr<ReceiveThreadContext> context);
+    static void ApplyReceiveThreadAttr(const SensorReceiveThreadAttr &attr);
     std::mutex eventRunnerMutex_;
+    uint32_t sharedRingCapacity_ = 0;
+    bool isReceiveThreadEnabled_ = false;
+    SensorReceiveThreadAttr receiveThreadAttr_ = {};
+    std::thread receiveThread_;
+    std::shared_ptr<ReceiveThreadContext> receiveContext_;
+    std::shared_ptr<MyFileDescriptorListener> listener_;
     static std::shared_ptr<MyEventHandler> eventHandler_;
     static std::shared_ptr<AppExecFwk::EventRunner> eventRunner_;
     static int32_t receiveFd_;
@@ -37,6 +37,7 @@ public:
     ErrCode TransferDataChannel(const sptr<SensorBasicDataChannel> &sensorBasicDataChannel,
                                 const sptr<IRemoteObject> &sensorClient) override;
     ErrCode DestroySensorChannel(sptr<IRemoteObject> sensorClient) override;
+    ErrCode SetSensorOption(uint32_t sensorId, int32_t option) override;
 
 private:
     DISALLOW_COPY_AND_MOVE(SensorServiceProxy);
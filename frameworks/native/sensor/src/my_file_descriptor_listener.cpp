@@ -14,6 +14,12 @@
  */
 
 #include "my_file_descriptor_listener.h"
+
+#include <cinttypes>
+#include <cstring>
+
+#include "sensor_shared_ring.h"
+#include "sensor_wire_format.h"
 #include "sensors_errors.h"
 #include "sensors_log_domain.h"
 
@@ -25,14 +31,17 @@ using namespace OHOS::AppExecFwk;
 namespace {
 constexpr HiLogLabel LABEL = { LOG_CORE, SensorsLogDomain::SENSOR_SERVICE, "MyFileDescriptorListener" };
 constexpr int32_t RECEIVE_DATA_SIZE = 100;
+// Compact records never exceed the fixed ones, a datagram of RECEIVE_DATA_SIZE events always fits
+constexpr size_t RECEIVE_FRAME_SIZE = sizeof(struct TransferSensorEvents) * RECEIVE_DATA_SIZE;
 }  // namespace
 
 MyFileDescriptorListener::MyFileDescriptorListener()
 {
     channel_ = nullptr;
-    receiveDataBuff_ =
-        new (std::nothrow) TransferSensorEvents[sizeof(struct TransferSensorEvents) * RECEIVE_DATA_SIZE];
+    receiveDataBuff_ = new (std::nothrow) TransferSensorEvents[RECEIVE_DATA_SIZE * RECEIVE_DATAGRAM_COUNT];
     CHKPL(receiveDataBuff_);
+    reportEventBuff_ = new (std::nothrow) SensorEvent[RECEIVE_DATA_SIZE * RECEIVE_DATAGRAM_COUNT];
+    CHKPL(reportEventBuff_);
 }
 
 MyFileDescriptorListener::~MyFileDescriptorListener()
@@ -42,39 +51,144 @@ MyFileDescriptorListener::~MyFileDescriptorListener()
         delete[] receiveDataBuff_;
         receiveDataBuff_ = nullptr;
     }
+    if (receiveFrameBuff_ != nullptr) {
+        delete[] receiveFrameBuff_;
+        receiveFrameBuff_ = nullptr;
+    }
+    if (reportEventBuff_ != nullptr) {
+        delete[] reportEventBuff_;
+        reportEventBuff_ = nullptr;
+    }
 }
 
 void MyFileDescriptorListener::OnReadable(int32_t fileDescriptor)
 {
-    CALL_LOG_ENTER;
     if (fileDescriptor < 0) {
         SEN_HILOGE("fileDescriptor: %{public}d", fileDescriptor);
         return;
     }
 
     FileDescriptorListener::OnReadable(fileDescriptor);
-    if (receiveDataBuff_ == nullptr) {
+    if (receiveDataBuff_ == nullptr || reportEventBuff_ == nullptr || isStopped_.load()) {
         return;
     }
-    int32_t len =
-        recv(fileDescriptor, receiveDataBuff_, sizeof(struct TransferSensorEvents) * RECEIVE_DATA_SIZE, 0);
-    int32_t eventSize = static_cast<int32_t>(sizeof(struct TransferSensorEvents));
-    while (len > 0) {
-        int32_t num = len / eventSize;
-        for (int i = 0; i < num; i++) {
-            SensorEvent event = {
-                .sensorTypeId = receiveDataBuff_[i].sensorTypeId,
-                .version = receiveDataBuff_[i].version,
-                .timestamp = receiveDataBuff_[i].timestamp,
-                .option = receiveDataBuff_[i].option,
-                .mode = receiveDataBuff_[i].mode,
-                .dataLen = receiveDataBuff_[i].dataLen,
-                .data = receiveDataBuff_[i].data
-            };
-            channel_->dataCB_(&event, 1, channel_->privateData_);
+    // Keep the ring mapped while draining, the channel may drop its reference from another thread meanwhile
+    std::shared_ptr<SensorSharedRing> sharedRing = channel_->GetSharedRing();
+    if (sharedRing != nullptr && fileDescriptor == sharedRing->GetEventFd()) {
+        OnSharedRingReadable(sharedRing);
+        return;
+    }
+    if (channel_->GetWireFormat() >= WIRE_FORMAT_COMPACT) {
+        OnCompactReadable(fileDescriptor);
+        return;
+    }
+    uint8_t *frames = reinterpret_cast<uint8_t *>(receiveDataBuff_);
+    int32_t count = ReceiveDatagrams(fileDescriptor, frames, RECEIVE_FRAME_SIZE);
+    while (count > 0) {
+        // Every datagram landed in its own frame, close the gaps so the callback gets one contiguous array
+        size_t num = 0;
+        for (int32_t i = 0; i < count; i++) {
+            size_t eventNum = receiveMsgs_[i].msg_len / sizeof(struct TransferSensorEvents);
+            size_t frameStart = static_cast<size_t>(i) * RECEIVE_DATA_SIZE;
+            if (frameStart != num && eventNum > 0) {
+                memmove(receiveDataBuff_ + num, receiveDataBuff_ + frameStart,
+                    eventNum * sizeof(struct TransferSensorEvents));
+            }
+            num += eventNum;
         }
-        len = recv(fileDescriptor, receiveDataBuff_, sizeof(struct TransferSensorEvents) * RECEIVE_DATA_SIZE, 0);
+        ReportEvents(static_cast<int32_t>(num));
+        // The callback may have unsubscribed and closed the channel, do not read from it again
+        if (count < static_cast<int32_t>(RECEIVE_DATAGRAM_COUNT) || isStopped_.load()) {
+            break;
+        }
+        count = ReceiveDatagrams(fileDescriptor, frames, RECEIVE_FRAME_SIZE);
+    }
+}
+
+void MyFileDescriptorListener::OnCompactReadable(int32_t fileDescriptor)
+{
+    if (receiveFrameBuff_ == nullptr) {
+        receiveFrameBuff_ = new (std::nothrow) uint8_t[RECEIVE_FRAME_SIZE * RECEIVE_DATAGRAM_COUNT];
+        CHKPV(receiveFrameBuff_);
+    }
+    int32_t count = ReceiveDatagrams(fileDescriptor, receiveFrameBuff_, RECEIVE_FRAME_SIZE);
+    while (count > 0) {
+        size_t num = 0;
+        for (int32_t i = 0; i < count; i++) {
+            num += SensorWireFormat::DecodeCompactEvents(receiveFrameBuff_ + i * RECEIVE_FRAME_SIZE,
+                receiveMsgs_[i].msg_len, receiveDataBuff_ + num, RECEIVE_DATA_SIZE * RECEIVE_DATAGRAM_COUNT - num);
+        }
+        ReportEvents(static_cast<int32_t>(num));
+        if (count < static_cast<int32_t>(RECEIVE_DATAGRAM_COUNT) || isStopped_.load()) {
+            break;
+        }
+        count = ReceiveDatagrams(fileDescriptor, receiveFrameBuff_, RECEIVE_FRAME_SIZE);
+    }
+}
+
+int32_t MyFileDescriptorListener::ReceiveDatagrams(int32_t fileDescriptor, uint8_t *frames, size_t frameSize)
+{
+    // One syscall drains up to RECEIVE_DATAGRAM_COUNT datagrams, each into its own frame of the reused buffer
+    for (uint32_t i = 0; i < RECEIVE_DATAGRAM_COUNT; i++) {
+        receiveIovs_[i].iov_base = frames + i * frameSize;
+        receiveIovs_[i].iov_len = frameSize;
+        receiveMsgs_[i].msg_hdr = {};
+        receiveMsgs_[i].msg_hdr.msg_iov = &receiveIovs_[i];
+        receiveMsgs_[i].msg_hdr.msg_iovlen = 1;
+        receiveMsgs_[i].msg_len = 0;
     }
+    return recvmmsg(fileDescriptor, receiveMsgs_, RECEIVE_DATAGRAM_COUNT, MSG_DONTWAIT, nullptr);
+}
+
+void MyFileDescriptorListener::OnSharedRingReadable(const std::shared_ptr<SensorSharedRing> &sharedRing)
+{
+    sharedRing->ClearWakeup();
+    // Stay off the waiting list while draining so the service does not signal for every batch
+    sharedRing->EndWait();
+    DrainSharedRing(sharedRing);
+    if (isStopped_.load() || channel_->GetSharedRing() != sharedRing) {
+        return;
+    }
+    sharedRing->BeginWait();
+    DrainSharedRing(sharedRing);
+}
+
+void MyFileDescriptorListener::DrainSharedRing(const std::shared_ptr<SensorSharedRing> &sharedRing)
+{
+    uint64_t lostCount = ringLostCount_;
+    uint32_t maxCount = RECEIVE_DATA_SIZE * RECEIVE_DATAGRAM_COUNT;
+    uint32_t num = sharedRing->Read(ringCursor_, receiveDataBuff_, maxCount, ringLostCount_);
+    while (num > 0) {
+        ReportEvents(static_cast<int32_t>(num));
+        // A callback may have unsubscribed and destroyed the channel, stop before touching the ring again
+        if (isStopped_.load() || channel_->GetSharedRing() != sharedRing) {
+            return;
+        }
+        num = sharedRing->Read(ringCursor_, receiveDataBuff_, maxCount, ringLostCount_);
+    }
+    if (ringLostCount_ != lostCount) {
+        SEN_HILOGW("shared ring overrun, lost : %{public}" PRIu64 ", total lost : %{public}" PRIu64,
+            ringLostCount_ - lostCount, ringLostCount_);
+    }
+}
+
+void MyFileDescriptorListener::ReportEvents(int32_t num)
+{
+    if (num <= 0) {
+        return;
+    }
+    for (int i = 0; i < num; i++) {
+        reportEventBuff_[i] = {
+            .sensorTypeId = receiveDataBuff_[i].sensorTypeId,
+            .version = receiveDataBuff_[i].version,
+            .timestamp = receiveDataBuff_[i].timestamp,
+            .option = receiveDataBuff_[i].option,
+            .mode = receiveDataBuff_[i].mode,
+            .dataLen = receiveDataBuff_[i].dataLen,
+            .data = receiveDataBuff_[i].data
+        };
+    }
+    channel_->dataCB_(reportEventBuff_, num, channel_->privateData_);
 }
 
 void MyFileDescriptorListener::OnWritable(int32_t fileDescriptor){}
@@ -84,6 +198,11 @@ void MyFileDescriptorListener::SetChannel(SensorDataChannel* channel)
     channel_ = channel;
 }
 
+void MyFileDescriptorListener::Stop()
+{
+    isStopped_.store(true);
+}
+
 void MyFileDescriptorListener::OnShutdown(int32_t fileDescriptor)
 {
     if (fileDescriptor < 0) {
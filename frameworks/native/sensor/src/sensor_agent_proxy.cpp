@@ -15,10 +15,17 @@
 
 #include "sensor_agent_proxy.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
 #include <cstring>
+#include <iterator>
+#include <limits>
+#include <sched.h>
 
 #include "securec.h"
 #include "sensor_catalog.h"
+#include "sensor_decimation.h"
 #include "sensor_service_client.h"
 #include "sensors_errors.h"
 #include "sensors_log_domain.h"
@@ -28,6 +35,12 @@ namespace OHOS {
 namespace Sensors {
 namespace {
 constexpr HiLogLabel LABEL = { LOG_CORE, OHOS::SensorsLogDomain::SENSORS_IMPLEMENT, "SensorAgentProxy" };
+#ifdef SENSOR_SHARED_RING_TRANSPORT
+constexpr uint32_t SHARED_RING_CAPACITY = 1024;
+#endif
+thread_local bool g_isDispatchThread = false;
+constexpr int32_t MAX_PULL_CAPACITY = 1 << 14;
+static_assert(SENSOR_SAMPLE_DATA_MAX_LEN == SENSOR_MAX_LENGTH, "SensorSample must hold every transfer event");
 
 using OHOS::ERR_OK;
 using OHOS::Sensors::BODY;
@@ -68,12 +81,15 @@ using OHOS::Sensors::SensorServiceClient;
 
 OHOS::sptr<SensorAgentProxy> SensorAgentProxy::sensorObj_ = nullptr;
 bool SensorAgentProxy::g_isChannelCreated;
-int64_t SensorAgentProxy::g_samplingInterval;
-int64_t SensorAgentProxy::g_reportInterval;
 std::mutex SensorAgentProxy::subscribeMutex_;
 std::mutex SensorAgentProxy::chanelMutex_;
-std::map<int32_t, const SensorUser *> SensorAgentProxy::g_subscribeMap;
-std::map<int32_t, const SensorUser *> SensorAgentProxy::g_unsubscribeMap;
+std::map<int32_t, SensorSubscription> SensorAgentProxy::g_subscribeMap;
+std::vector<SensorEvent> SensorAgentProxy::g_batchEvents;
+std::vector<SensorEvent> SensorAgentProxy::g_dueEvents;
+std::vector<int32_t> SensorAgentProxy::g_batchedSensors;
+std::shared_ptr<const SensorDispatchTable> SensorAgentProxy::g_dispatchTable =
+    std::make_shared<const SensorDispatchTable>();
+std::atomic<uint64_t> SensorAgentProxy::g_dispatchSequence { 0 };
 
 SensorAgentProxy::SensorAgentProxy()
     : dataChannel_(new (std::nothrow) SensorDataChannel())
@@ -97,16 +113,193 @@ void SensorAgentProxy::HandleSensorData(struct SensorEvent *events, int32_t num,
         SEN_HILOGE("events is null or num is invalid");
         return;
     }
-    struct SensorEvent eventStream;
+    // Odd while a read is being dispatched, lets DeactivateSensor wait out callbacks of an older table
+    g_dispatchSequence.fetch_add(1);
+    g_isDispatchThread = true;
+    auto dispatchTable = std::atomic_load(&g_dispatchTable);
+    g_batchedSensors.clear();
     for (int32_t i = 0; i < num; ++i) {
-        eventStream = events[i];
-        if (g_subscribeMap.find(eventStream.sensorTypeId) == g_subscribeMap.end()) {
-            SEN_HILOGE("sensorTypeId not in g_subscribeMap");
-            return;
+        int32_t sensorId = events[i].sensorTypeId;
+        // Events of one sensor come in runs, all events of a sensor in this read are handled at its first one
+        if ((i > 0 && sensorId == events[i - 1].sensorTypeId) ||
+            std::find(g_batchedSensors.begin(), g_batchedSensors.end(), sensorId) != g_batchedSensors.end()) {
+            continue;
         }
-        CHKPV(g_subscribeMap[eventStream.sensorTypeId]);
-        g_subscribeMap[eventStream.sensorTypeId]->callback(&eventStream);
+        g_batchedSensors.push_back(sensorId);
+        const SensorDispatchEntry *entry = FindDispatchEntry(*dispatchTable, sensorId);
+        if (entry == nullptr || entry->subscribers.empty()) {
+            SEN_HILOGE("sensorTypeId not in g_subscribeMap, sensorTypeId : %{public}d", sensorId);
+            continue;
+        }
+        int32_t count = 0;
+        SensorEvent *sensorEvents = GatherSensorEvents(events + i, num - i, count);
+        for (const auto &subscriber : entry->subscribers) {
+            DispatchEvents(sensorEvents, count, subscriber, entry->streamInterval);
+        }
+    }
+    g_isDispatchThread = false;
+    g_dispatchSequence.fetch_add(1);
+}
+
+void SensorAgentProxy::PublishDispatchTable()
+{
+    auto dispatchTable = std::make_shared<SensorDispatchTable>();
+    // g_subscribeMap is ordered, so the entries come out sorted by sensorId
+    for (const auto &it : g_subscribeMap) {
+        const SensorSubscription &subscription = it.second;
+        if (!subscription.isEnabled) {
+            continue;
+        }
+        dispatchTable->sensors.emplace_back();
+        SensorDispatchEntry &entry = dispatchTable->sensors.back();
+        entry.sensorId = it.first;
+        std::copy_if(subscription.subscribers.begin(), subscription.subscribers.end(),
+            std::back_inserter(entry.subscribers), [](const SensorSubscriber &subscriber) {
+                return subscriber.isActive;
+            });
+        entry.streamInterval = subscription.samplingInterval;
+    }
+    std::atomic_store(&g_dispatchTable, std::shared_ptr<const SensorDispatchTable>(std::move(dispatchTable)));
+}
+
+const SensorDispatchEntry *SensorAgentProxy::FindDispatchEntry(const SensorDispatchTable &dispatchTable,
+    int32_t sensorId)
+{
+    const auto &sensors = dispatchTable.sensors;
+    auto entry = std::lower_bound(sensors.begin(), sensors.end(), sensorId,
+        [](const SensorDispatchEntry &item, int32_t id) { return item.sensorId < id; });
+    return (entry == sensors.end() || entry->sensorId != sensorId) ? nullptr : &(*entry);
+}
+
+void SensorAgentProxy::WaitForDispatch()
+{
+    // A callback changing subscriptions cannot wait for the read it is called from
+    if (g_isDispatchThread) {
+        return;
+    }
+    uint64_t sequence = g_dispatchSequence.load();
+    if ((sequence % 2) == 0) {
+        return;
+    }
+    while (g_dispatchSequence.load() == sequence) {
+        std::this_thread::yield();
+    }
+}
+
+SensorEvent *SensorAgentProxy::GatherSensorEvents(SensorEvent *events, int32_t num, int32_t &count)
+{
+    int32_t sensorId = events[0].sensorTypeId;
+    int32_t runEnd = 1;
+    while (runEnd < num && events[runEnd].sensorTypeId == sensorId) {
+        runEnd++;
+    }
+    auto isSameSensor = [sensorId](const SensorEvent &event) { return event.sensorTypeId == sensorId; };
+    if (std::none_of(events + runEnd, events + num, isSameSensor)) {
+        // The usual case, a FIFO batch arrives as one run and is handed over without copying
+        count = runEnd;
+        return events;
     }
+    g_batchEvents.assign(events, events + runEnd);
+    std::copy_if(events + runEnd, events + num, std::back_inserter(g_batchEvents), isSameSensor);
+    count = static_cast<int32_t>(g_batchEvents.size());
+    return g_batchEvents.data();
+}
+
+void SensorAgentProxy::DispatchEvents(SensorEvent *events, int32_t num, const SensorSubscriber &subscriber,
+    int64_t streamInterval)
+{
+    if (subscriber.samplingInterval > streamInterval && subscriber.nextDueTimestamp != nullptr) {
+        // The shared stream runs at the rate of a more demanding user, drop what this one did not ask for
+        g_dueEvents.clear();
+        for (int32_t i = 0; i < num; ++i) {
+            if (SensorDecimation::IsSampleDue(*subscriber.nextDueTimestamp, events[i].timestamp,
+                subscriber.samplingInterval, streamInterval / 2)) {
+                g_dueEvents.push_back(events[i]);
+            }
+        }
+        events = g_dueEvents.data();
+        num = static_cast<int32_t>(g_dueEvents.size());
+    }
+    if (num == 0) {
+        return;
+    }
+    if (subscriber.pullBuffer != nullptr) {
+        WritePullEvents(*subscriber.pullBuffer, events, num);
+        return;
+    }
+    if (subscriber.batchCallback != nullptr) {
+        subscriber.batchCallback(events, num);
+        return;
+    }
+    for (int32_t i = 0; i < num; ++i) {
+        struct SensorEvent eventStream = events[i];
+        subscriber.user->callback(&eventStream);
+    }
+}
+
+SensorSubscriber *SensorAgentProxy::FindUser(int32_t sensorId, const SensorUser *user)
+{
+    auto it = g_subscribeMap.find(sensorId);
+    if (it == g_subscribeMap.end()) {
+        return nullptr;
+    }
+    auto &subscribers = it->second.subscribers;
+    auto subscriber = std::find_if(subscribers.begin(), subscribers.end(),
+        [user](const SensorSubscriber &item) { return item.user == user; });
+    return (subscriber == subscribers.end()) ? nullptr : &(*subscriber);
+}
+
+bool SensorAgentProxy::HasOptionConflict(int32_t sensorId, const SensorUser *user, int32_t option)
+{
+    // The service applies options to the one stream all users of a sensor share, so they have to agree on them
+    auto it = g_subscribeMap.find(sensorId);
+    if (it == g_subscribeMap.end()) {
+        return false;
+    }
+    return std::any_of(it->second.subscribers.begin(), it->second.subscribers.end(),
+        [user, option](const SensorSubscriber &item) { return item.user != user && item.option != option; });
+}
+
+int32_t SensorAgentProxy::UpdateSensorParams(int32_t sensorId)
+{
+    SensorSubscription &subscription = g_subscribeMap[sensorId];
+    bool hasActiveUser = false;
+    int64_t samplingInterval = std::numeric_limits<int64_t>::max();
+    int64_t reportInterval = std::numeric_limits<int64_t>::max();
+    for (const auto &subscriber : subscription.subscribers) {
+        if (!subscriber.isActive) {
+            continue;
+        }
+        hasActiveUser = true;
+        samplingInterval = std::min(samplingInterval, subscriber.samplingInterval);
+        reportInterval = std::min(reportInterval, subscriber.reportInterval);
+    }
+    SensorServiceClient &client = SensorServiceClient::GetInstance();
+    if (!hasActiveUser) {
+        if (!subscription.isEnabled) {
+            return ERR_OK;
+        }
+        subscription.isEnabled = false;
+        int32_t ret = client.DisableSensor(sensorId);
+        if (ret != ERR_OK) {
+            SEN_HILOGE("disable sensor failed, ret: %{public}d", ret);
+        }
+        return ret;
+    }
+    if (subscription.isEnabled && subscription.samplingInterval == samplingInterval &&
+        subscription.reportInterval == reportInterval) {
+        return ERR_OK;
+    }
+    // The service keeps one subscription per process and sensor, enabling again replaces its parameters
+    int32_t ret = client.EnableSensor(sensorId, samplingInterval, reportInterval);
+    if (ret != ERR_OK) {
+        SEN_HILOGE("enable sensor failed, ret: %{public}d", ret);
+        return ret;
+    }
+    subscription.isEnabled = true;
+    subscription.samplingInterval = samplingInterval;
+    subscription.reportInterval = reportInterval;
+    return ERR_OK;
 }
 
 int32_t SensorAgentProxy::CreateSensorDataChannel() const
@@ -118,6 +311,9 @@ int32_t SensorAgentProxy::CreateSensorDataChannel() const
         return ERR_OK;
     }
     CHKPR(dataChannel_, INVALID_POINTER);
+#ifdef SENSOR_SHARED_RING_TRANSPORT
+    dataChannel_->SetSharedRingCapacity(SHARED_RING_CAPACITY);
+#endif
     auto ret = dataChannel_->CreateSensorDataChannel(HandleSensorData, nullptr);
     if (ret != ERR_OK) {
         SEN_HILOGE("create data channel failed, ret: %{public}d", ret);
@@ -161,52 +357,52 @@ int32_t SensorAgentProxy::DestroySensorDataChannel() const
 int32_t SensorAgentProxy::ActivateSensor(int32_t sensorId, const SensorUser *user) const
 {
     CHKPR(user, OHOS::Sensors::ERROR);
-    CHKPR(user->callback, OHOS::Sensors::ERROR);
     if (sensorId < 0) {
         SEN_HILOGE("user is null or sensorId is invalid");
         return ERROR;
     }
-    if (g_samplingInterval < 0 || g_reportInterval < 0) {
-        SEN_HILOGE("samplingPeroid or g_reportInterval is invalid");
-        return ERROR;
-    }
     std::lock_guard<std::mutex> subscribeLock(subscribeMutex_);
-    if ((g_subscribeMap.find(sensorId) == g_subscribeMap.end()) || (g_subscribeMap[sensorId] != user)) {
+    SensorSubscriber *subscriber = FindUser(sensorId, user);
+    if (subscriber == nullptr) {
         SEN_HILOGE("subscribe sensorId first");
         return ERROR;
     }
-    SensorServiceClient &client = SensorServiceClient::GetInstance();
-    int32_t ret = client.EnableSensor(sensorId, g_samplingInterval, g_reportInterval);
-    g_samplingInterval = -1;
-    g_reportInterval = -1;
-    if (ret != 0) {
-        SEN_HILOGE("enable sensor failed, ret: %{public}d", ret);
-        g_subscribeMap.erase(sensorId);
-
+    bool isActive = subscriber->isActive;
+    subscriber->isActive = true;
+    if (!isActive) {
+        subscriber->nextDueTimestamp = std::make_shared<int64_t>(0);
+    }
+    int32_t ret = UpdateSensorParams(sensorId);
+    if (ret != ERR_OK) {
+        subscriber->isActive = isActive;
         return OHOS::Sensors::ERROR;
     }
+    PublishDispatchTable();
     return OHOS::Sensors::SUCCESS;
 }
 
 int32_t SensorAgentProxy::DeactivateSensor(int32_t sensorId, const SensorUser *user) const
 {
     CHKPR(user, OHOS::Sensors::ERROR);
-    CHKPR(user->callback, OHOS::Sensors::ERROR);
     if (sensorId < 0) {
         SEN_HILOGE("user is null or sensorId is invalid");
         return OHOS::Sensors::ERROR;
     }
-    std::lock_guard<std::mutex> subscribeLock(subscribeMutex_);
-    if ((g_subscribeMap.find(sensorId) == g_subscribeMap.end()) || (g_subscribeMap[sensorId] != user)) {
-        SEN_HILOGE("subscribe sensorId first");
-        return OHOS::Sensors::ERROR;
+    int32_t ret = ERR_OK;
+    {
+        std::lock_guard<std::mutex> subscribeLock(subscribeMutex_);
+        SensorSubscriber *subscriber = FindUser(sensorId, user);
+        if (subscriber == nullptr || !subscriber->isActive) {
+            SEN_HILOGE("activate sensorId first");
+            return OHOS::Sensors::ERROR;
+        }
+        subscriber->isActive = false;
+        ret = UpdateSensorParams(sensorId);
+        PublishDispatchTable();
     }
-    g_subscribeMap.erase(sensorId);
-    g_unsubscribeMap[sensorId] = user;
-    SensorServiceClient &client = SensorServiceClient::GetInstance();
-    int32_t ret = client.DisableSensor(sensorId);
-    if (ret != 0) {
-        SEN_HILOGE("disable sensor failed, ret: %{public}d", ret);
+    // Once this returns the user is not called any more and may be released
+    WaitForDispatch();
+    if (ret != ERR_OK) {
         return OHOS::Sensors::ERROR;
     }
     return OHOS::Sensors::SUCCESS;
@@ -225,12 +421,25 @@ int32_t SensorAgentProxy::SetBatch(int32_t sensorId, const SensorUser *user, int
         return OHOS::Sensors::ERROR;
     }
     std::lock_guard<std::mutex> subscribeLock(subscribeMutex_);
-    if ((g_subscribeMap.find(sensorId) == g_subscribeMap.end()) || (g_subscribeMap.at(sensorId) != user)) {
+    SensorSubscriber *subscriber = FindUser(sensorId, user);
+    if (subscriber == nullptr) {
         SEN_HILOGE("subscribe sensorId first");
         return OHOS::Sensors::ERROR;
     }
-    g_samplingInterval = samplingInterval;
-    g_reportInterval = reportInterval;
+    int64_t lastSamplingInterval = subscriber->samplingInterval;
+    int64_t lastReportInterval = subscriber->reportInterval;
+    subscriber->samplingInterval = samplingInterval;
+    subscriber->reportInterval = reportInterval;
+    if (!subscriber->isActive) {
+        return OHOS::Sensors::SUCCESS;
+    }
+    int32_t ret = UpdateSensorParams(sensorId);
+    if (ret != ERR_OK) {
+        subscriber->samplingInterval = lastSamplingInterval;
+        subscriber->reportInterval = lastReportInterval;
+        return OHOS::Sensors::ERROR;
+    }
+    PublishDispatchTable();
     return OHOS::Sensors::SUCCESS;
 }
 
@@ -239,6 +448,198 @@ int32_t SensorAgentProxy::SubscribeSensor(int32_t sensorId, const SensorUser *us
     SEN_HILOGI("in, sensorId: %{public}d", sensorId);
     CHKPR(user, OHOS::Sensors::ERROR);
     CHKPR(user->callback, OHOS::Sensors::ERROR);
+    SensorSubscriber subscriber;
+    subscriber.user = user;
+    return Subscribe(sensorId, subscriber);
+}
+
+int32_t SensorAgentProxy::SubscribeSensorBatch(int32_t sensorId, const SensorBatchUser *user) const
+{
+    SEN_HILOGI("in, sensorId: %{public}d", sensorId);
+    CHKPR(user, OHOS::Sensors::ERROR);
+    CHKPR(user->batchCallback, OHOS::Sensors::ERROR);
+    SensorSubscriber subscriber;
+    subscriber.user = &user->user;
+    subscriber.batchCallback = user->batchCallback;
+    return Subscribe(sensorId, subscriber);
+}
+
+int32_t SensorAgentProxy::SubscribeSensorPull(int32_t sensorId, const SensorPullUser *user) const
+{
+    SEN_HILOGI("in, sensorId: %{public}d", sensorId);
+    CHKPR(user, OHOS::Sensors::ERROR);
+    if (user->capacity <= 0) {
+        SEN_HILOGE("capacity is invalid, capacity : %{public}d", user->capacity);
+        return OHOS::Sensors::ERROR;
+    }
+    auto pullBuffer = std::make_shared<SensorPullBuffer>();
+    CHKPR(pullBuffer, OHOS::Sensors::ERROR);
+    pullBuffer->capacity = static_cast<uint64_t>(std::min(user->capacity, MAX_PULL_CAPACITY));
+    pullBuffer->slots.reset(new (std::nothrow) SensorPullSlot[pullBuffer->capacity]);
+    CHKPR(pullBuffer->slots, OHOS::Sensors::ERROR);
+    SensorSubscriber subscriber;
+    subscriber.user = &user->user;
+    subscriber.pullBuffer = pullBuffer;
+    return Subscribe(sensorId, subscriber);
+}
+
+int32_t SensorAgentProxy::ReadSensorEvents(int32_t sensorId, const SensorUser *user, SensorSample *samples,
+    int32_t maxCount, int64_t timeoutNs) const
+{
+    CHKPR(samples, OHOS::Sensors::ERROR);
+    if (maxCount <= 0 || timeoutNs < 0) {
+        SEN_HILOGE("maxCount or timeoutNs is invalid");
+        return OHOS::Sensors::ERROR;
+    }
+    std::shared_ptr<SensorPullBuffer> pullBuffer = FindPullBuffer(sensorId, user);
+    if (pullBuffer == nullptr) {
+        SEN_HILOGE("subscribe sensorId for pulling and activate it first");
+        return OHOS::Sensors::ERROR;
+    }
+    int32_t count = PullEvents(*pullBuffer, samples, maxCount);
+    if (count > 0 || timeoutNs == 0) {
+        return count;
+    }
+    WaitForPullEvents(*pullBuffer, timeoutNs);
+    return PullEvents(*pullBuffer, samples, maxCount);
+}
+
+int32_t SensorAgentProxy::GetLatestSensorEvent(int32_t sensorId, const SensorUser *user, SensorSample *sample) const
+{
+    CHKPR(sample, OHOS::Sensors::ERROR);
+    std::shared_ptr<SensorPullBuffer> pullBuffer = FindPullBuffer(sensorId, user);
+    if (pullBuffer == nullptr) {
+        SEN_HILOGE("subscribe sensorId for pulling and activate it first");
+        return OHOS::Sensors::ERROR;
+    }
+    while (true) {
+        uint64_t writeCursor = pullBuffer->writeCursor.load(std::memory_order_acquire);
+        if (writeCursor == 0) {
+            return OHOS::Sensors::ERROR;
+        }
+        const SensorPullSlot &slot = pullBuffer->slots[(writeCursor - 1) % pullBuffer->capacity];
+        if (slot.sequence.load(std::memory_order_acquire) != writeCursor) {
+            // Already rewritten by a newer sample, whose cursor is published by now or shortly
+            continue;
+        }
+        *sample = slot.sample;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == writeCursor) {
+            return OHOS::Sensors::SUCCESS;
+        }
+    }
+}
+
+std::shared_ptr<SensorPullBuffer> SensorAgentProxy::FindPullBuffer(int32_t sensorId, const SensorUser *user)
+{
+    if (user == nullptr || sensorId < 0) {
+        return nullptr;
+    }
+    // Same snapshot as HandleSensorData, polling a sensor takes no lock
+    auto dispatchTable = std::atomic_load(&g_dispatchTable);
+    const SensorDispatchEntry *entry = FindDispatchEntry(*dispatchTable, sensorId);
+    if (entry == nullptr) {
+        return nullptr;
+    }
+    for (const auto &subscriber : entry->subscribers) {
+        if (subscriber.user == user) {
+            return subscriber.pullBuffer;
+        }
+    }
+    return nullptr;
+}
+
+void SensorAgentProxy::WritePullEvents(SensorPullBuffer &pullBuffer, const SensorEvent *events, int32_t num)
+{
+    // Only the receive thread writes, the cursor is published once the whole batch is in place
+    uint64_t writeCursor = pullBuffer.writeCursor.load(std::memory_order_relaxed);
+    for (int32_t i = 0; i < num; ++i) {
+        SensorPullSlot &slot = pullBuffer.slots[writeCursor % pullBuffer.capacity];
+        // A zero sequence marks the slot as being rewritten, readers that raced with us drop their copy
+        slot.sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        SensorSample &sample = slot.sample;
+        sample.sensorTypeId = events[i].sensorTypeId;
+        sample.version = events[i].version;
+        sample.timestamp = events[i].timestamp;
+        sample.option = events[i].option;
+        sample.mode = events[i].mode;
+        sample.dataLen = std::min(events[i].dataLen, static_cast<uint32_t>(SENSOR_SAMPLE_DATA_MAX_LEN));
+        if (memcpy_s(sample.data, sizeof(sample.data), events[i].data, sample.dataLen) != EOK) {
+            sample.dataLen = 0;
+        }
+        slot.sequence.store(writeCursor + 1, std::memory_order_release);
+        writeCursor++;
+    }
+    pullBuffer.writeCursor.store(writeCursor, std::memory_order_release);
+    // Pairs with WaitForPullEvents, either the reader sees the new cursor or we see it waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (pullBuffer.waitingReaders.load(std::memory_order_relaxed) != 0) {
+        std::lock_guard<std::mutex> waitLock(pullBuffer.waitMutex);
+        pullBuffer.waitCondition.notify_all();
+    }
+}
+
+void SensorAgentProxy::WaitForPullEvents(SensorPullBuffer &pullBuffer, int64_t timeoutNs)
+{
+    pullBuffer.waitingReaders.fetch_add(1, std::memory_order_seq_cst);
+    {
+        std::unique_lock<std::mutex> waitLock(pullBuffer.waitMutex);
+        pullBuffer.waitCondition.wait_for(waitLock, std::chrono::nanoseconds(timeoutNs), [&pullBuffer] {
+            return pullBuffer.writeCursor.load(std::memory_order_seq_cst) !=
+                pullBuffer.readCursor.load(std::memory_order_acquire);
+        });
+    }
+    pullBuffer.waitingReaders.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+int32_t SensorAgentProxy::PullEvents(SensorPullBuffer &pullBuffer, SensorSample *samples, int32_t maxCount)
+{
+    uint64_t capacity = pullBuffer.capacity;
+    uint64_t readCursor = pullBuffer.readCursor.load(std::memory_order_acquire);
+    while (true) {
+        uint64_t writeCursor = pullBuffer.writeCursor.load(std::memory_order_acquire);
+        uint64_t cursor = readCursor;
+        uint64_t lostCount = 0;
+        int32_t count = 0;
+        while (count < maxCount && cursor < writeCursor) {
+            if (writeCursor - cursor > capacity) {
+                // The writer lapped the readers, resume from the oldest slot that is still intact
+                lostCount += writeCursor - capacity - cursor;
+                cursor = writeCursor - capacity;
+            }
+            const SensorPullSlot &slot = pullBuffer.slots[cursor % capacity];
+            uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence == cursor + 1) {
+                samples[count] = slot.sample;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.sequence.load(std::memory_order_relaxed) == sequence) {
+                    count++;
+                    cursor++;
+                    continue;
+                }
+            }
+            // The slot was rewritten under us, refresh the writer position and skip what was lost
+            writeCursor = pullBuffer.writeCursor.load(std::memory_order_acquire);
+            if (writeCursor - cursor <= capacity) {
+                lostCount++;
+                cursor++;
+            }
+        }
+        // Concurrent readers claim what they copied, a reader losing the race starts over from the new cursor
+        if (cursor == readCursor || pullBuffer.readCursor.compare_exchange_weak(readCursor, cursor,
+            std::memory_order_acq_rel, std::memory_order_acquire)) {
+            if (lostCount != 0) {
+                pullBuffer.lostCount.fetch_add(lostCount, std::memory_order_relaxed);
+                SEN_HILOGW("pull buffer overrun, lost : %{public}" PRIu64, lostCount);
+            }
+            return count;
+        }
+    }
+}
+
+int32_t SensorAgentProxy::Subscribe(int32_t sensorId, const SensorSubscriber &subscriber) const
+{
     if (sensorId < 0) {
         SEN_HILOGE("user or sensorId is invalid");
         return OHOS::Sensors::ERROR;
@@ -249,7 +650,19 @@ int32_t SensorAgentProxy::SubscribeSensor(int32_t sensorId, const SensorUser *us
         return OHOS::Sensors::ERROR;
     }
     std::lock_guard<std::mutex> subscribeLock(subscribeMutex_);
-    g_subscribeMap[sensorId] = user;
+    SensorSubscriber *existing = FindUser(sensorId, subscriber.user);
+    if (existing != nullptr) {
+        // Subscribing again only swaps the callback, the parameters and the active state are kept
+        existing->batchCallback = subscriber.batchCallback;
+        existing->pullBuffer = subscriber.pullBuffer;
+        PublishDispatchTable();
+        return OHOS::Sensors::SUCCESS;
+    }
+    if (HasOptionConflict(sensorId, subscriber.user, SENSOR_OPTION_DEFAULT)) {
+        SEN_HILOGE("sensorId: %{public}d is streamed with an option of another user", sensorId);
+        return OHOS::Sensors::ERROR;
+    }
+    g_subscribeMap[sensorId].subscribers.push_back(subscriber);
     return OHOS::Sensors::SUCCESS;
 }
 
@@ -257,16 +670,21 @@ int32_t SensorAgentProxy::UnsubscribeSensor(int32_t sensorId, const SensorUser *
 {
     SEN_HILOGI("in, sensorId: %{public}d", sensorId);
     CHKPR(user, OHOS::Sensors::ERROR);
-    CHKPR(user->callback, OHOS::Sensors::ERROR);
     if (sensorId < 0) {
         SEN_HILOGE("user is null or sensorId is invalid");
         return OHOS::Sensors::ERROR;
     }
     std::lock_guard<std::mutex> subscribeLock(subscribeMutex_);
-    if (g_unsubscribeMap.find(sensorId) == g_unsubscribeMap.end() || g_unsubscribeMap[sensorId] != user) {
+    SensorSubscriber *subscriber = FindUser(sensorId, user);
+    if (subscriber == nullptr || subscriber->isActive) {
         SEN_HILOGE("deactivate sensorId first");
         return OHOS::Sensors::ERROR;
     }
+    auto &subscribers = g_subscribeMap[sensorId].subscribers;
+    subscribers.erase(subscribers.begin() + (subscriber - subscribers.data()));
+    if (subscribers.empty()) {
+        g_subscribeMap.erase(sensorId);
+    }
     if (g_subscribeMap.empty()) {
         int32_t ret = DestroySensorDataChannel();
         if (ret != ERR_OK) {
@@ -274,20 +692,18 @@ int32_t SensorAgentProxy::UnsubscribeSensor(int32_t sensorId, const SensorUser *
             return ret;
         }
     }
-    g_unsubscribeMap.erase(sensorId);
     return OHOS::Sensors::SUCCESS;
 }
 
 int32_t SensorAgentProxy::SetMode(int32_t sensorId, const SensorUser *user, int32_t mode) const
 {
     CHKPR(user, OHOS::Sensors::ERROR);
-    CHKPR(user->callback, OHOS::Sensors::ERROR);
     if (sensorId < 0) {
         SEN_HILOGE("user is null or sensorId is invalid");
         return OHOS::Sensors::ERROR;
     }
     std::lock_guard<std::mutex> subscribeLock(subscribeMutex_);
-    if ((g_subscribeMap.find(sensorId) == g_subscribeMap.end()) || (g_subscribeMap.at(sensorId) != user)) {
+    if (FindUser(sensorId, user) == nullptr) {
         SEN_HILOGE("subscribe sensorId first");
         return OHOS::Sensors::ERROR;
     }
@@ -297,16 +713,48 @@ int32_t SensorAgentProxy::SetMode(int32_t sensorId, const SensorUser *user, int3
 int32_t SensorAgentProxy::SetOption(int32_t sensorId, const SensorUser *user, int32_t option) const
 {
     CHKPR(user, OHOS::Sensors::ERROR);
-    CHKPR(user->callback, OHOS::Sensors::ERROR);
     if (sensorId < 0) {
         SEN_HILOGE("user is null or sensorId is invalid");
         return OHOS::Sensors::ERROR;
     }
     std::lock_guard<std::mutex> subscribeLock(subscribeMutex_);
-    if ((g_subscribeMap.find(sensorId) == g_subscribeMap.end()) || (g_subscribeMap.at(sensorId) != user)) {
+    SensorSubscriber *subscriber = FindUser(sensorId, user);
+    if (subscriber == nullptr) {
         SEN_HILOGE("subscribe sensorId first");
         return OHOS::Sensors::ERROR;
     }
+    if ((option < SENSOR_OPTION_DEFAULT) || (option >= SENSOR_OPTION_MAX)) {
+        SEN_HILOGE("option is invalid, option : %{public}d", option);
+        return OHOS::Sensors::ERROR;
+    }
+    if (HasOptionConflict(sensorId, user, option)) {
+        SEN_HILOGE("option conflicts with another user of sensorId: %{public}d, option : %{public}d", sensorId,
+            option);
+        return OHOS::Sensors::ERROR;
+    }
+    SensorServiceClient &client = SensorServiceClient::GetInstance();
+    int32_t ret = client.SetSensorOption(sensorId, option);
+    if (ret != ERR_OK) {
+        SEN_HILOGE("set sensor option failed, ret : %{public}d", ret);
+        return OHOS::Sensors::ERROR;
+    }
+    subscriber->option = option;
+    return OHOS::Sensors::SUCCESS;
+}
+
+int32_t SensorAgentProxy::SetReceiveThread(const SensorReceiveThreadAttr *attr) const
+{
+    if (attr != nullptr && (attr->priority < 0 || attr->priority > sched_get_priority_max(SCHED_FIFO))) {
+        SEN_HILOGE("priority is invalid, priority : %{public}d", attr->priority);
+        return OHOS::Sensors::ERROR;
+    }
+    std::lock_guard<std::mutex> chanelLock(chanelMutex_);
+    if (g_isChannelCreated) {
+        SEN_HILOGE("the channel has already been created, unsubscribe all sensors first");
+        return OHOS::Sensors::ERROR;
+    }
+    CHKPR(dataChannel_, OHOS::Sensors::ERROR);
+    dataChannel_->SetReceiveThread(attr);
     return OHOS::Sensors::SUCCESS;
 }
 
@@ -16,12 +16,18 @@
 #include "sensor_data_channel.h"
 
 #include <cerrno>
+#include <pthread.h>
+#include <sched.h>
 #include <unistd.h>
+#include <vector>
 
 #include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 
 #include "my_file_descriptor_listener.h"
+#include "sensor_shared_ring.h"
 #include "sensors_errors.h"
 #include "sensors_log_domain.h"
 #include "string_ex.h"
@@ -38,8 +44,37 @@ std::shared_ptr<MyEventHandler> SensorDataChannel::eventHandler_;
 
 namespace {
 constexpr HiLogLabel LABEL = { LOG_CORE, SensorsLogDomain::SENSOR_NATIVE, "SensorDataChannel" };
+constexpr int32_t MAX_EPOLL_EVENTS = 4;
+constexpr uint32_t CPU_MASK_BITS = 64;
 }  // namespace
 
+/*
+ * State shared by the channel and its receive thread. The thread reads its own duplicate of the data fd and keeps
+ * the shared ring alive, everything is released once both let go of it. A thread detached from inside a data
+ * callback can thus finish its loop after the channel has closed its fds and dropped the ring.
+ */
+struct ReceiveThreadContext {
+    ~ReceiveThreadContext()
+    {
+        if (epollFd >= 0) {
+            close(epollFd);
+        }
+        if (stopFd >= 0) {
+            close(stopFd);
+        }
+        if (dataFd >= 0) {
+            close(dataFd);
+        }
+    }
+    int32_t epollFd = -1;
+    int32_t stopFd = -1;
+    int32_t dataFd = -1;
+    std::shared_ptr<SensorSharedRing> sharedRing;
+    std::atomic<bool> isStopped { false };
+    std::shared_ptr<MyFileDescriptorListener> listener;
+    SensorReceiveThreadAttr attr = {};
+};
+
 int32_t SensorDataChannel::CreateSensorDataChannel(DataChannelCB callBack, void *data)
 {
     CHKPR(callBack, SENSOR_NATIVE_REGSITER_CB_ERR);
@@ -69,6 +104,11 @@ int32_t SensorDataChannel::InnerSensorDataChannel()
     }
     auto listener = std::make_shared<MyFileDescriptorListener>();
     listener->SetChannel(this);
+    listener_ = listener;
+    InitSharedRing();
+    if (isReceiveThreadEnabled_) {
+        return StartReceiveThread(listener);
+    }
     auto myRunner = AppExecFwk::EventRunner::Create(true);
     CHKPR(myRunner, ERROR);
     eventHandler_ = std::make_shared<MyEventHandler>(myRunner);
@@ -80,14 +120,170 @@ int32_t SensorDataChannel::InnerSensorDataChannel()
         SEN_HILOGE("AddFileDescriptorListener fail");
         return ERROR;
     }
+    return AddSharedRingListener(listener);
+}
+
+void SensorDataChannel::SetSharedRingCapacity(uint32_t capacity)
+{
+    sharedRingCapacity_ = capacity;
+}
+
+void SensorDataChannel::SetReceiveThread(const SensorReceiveThreadAttr *attr)
+{
+    std::lock_guard<std::mutex> eventRunnerLock(eventRunnerMutex_);
+    isReceiveThreadEnabled_ = (attr != nullptr);
+    receiveThreadAttr_ = isReceiveThreadEnabled_ ? *attr : SensorReceiveThreadAttr {};
+}
+
+void SensorDataChannel::InitSharedRing()
+{
+    if (sharedRingCapacity_ == 0) {
+        return;
+    }
+    // The socket stays registered, a service that cannot map the ring keeps sending through it
+    int32_t ret = CreateSharedRing(sharedRingCapacity_);
+    if (ret != ERR_OK) {
+        SEN_HILOGW("shared ring unavailable, use socket only, ret : %{public}d", ret);
+    }
+}
+
+int32_t SensorDataChannel::AddSharedRingListener(const std::shared_ptr<AppExecFwk::FileDescriptorListener> &listener)
+{
+    auto sharedRing = GetSharedRing();
+    if (sharedRing == nullptr) {
+        return ERR_OK;
+    }
+    auto inResult = eventHandler_->AddFileDescriptorListener(sharedRing->GetEventFd(),
+        AppExecFwk::FILE_DESCRIPTOR_INPUT_EVENT, listener);
+    if (inResult != 0) {
+        SEN_HILOGE("AddFileDescriptorListener for shared ring fail");
+        return ERROR;
+    }
+    sharedRing->BeginWait();
     return ERR_OK;
 }
 
+int32_t SensorDataChannel::StartReceiveThread(const std::shared_ptr<MyFileDescriptorListener> &listener)
+{
+    auto context = std::make_shared<ReceiveThreadContext>();
+    context->listener = listener;
+    context->attr = receiveThreadAttr_;
+    context->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (context->epollFd < 0) {
+        SEN_HILOGE("epoll_create1 failed, errno : %{public}d", errno);
+        return ERROR;
+    }
+    context->stopFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (context->stopFd < 0) {
+        SEN_HILOGE("eventfd failed, errno : %{public}d", errno);
+        return ERROR;
+    }
+    context->dataFd = fcntl(GetReceiveDataFd(), F_DUPFD_CLOEXEC, 0);
+    if (context->dataFd < 0) {
+        SEN_HILOGE("dup receive fd failed, errno : %{public}d", errno);
+        return ERROR;
+    }
+    std::vector<int32_t> fds = { context->dataFd, context->stopFd };
+    context->sharedRing = GetSharedRing();
+    if (context->sharedRing != nullptr) {
+        fds.push_back(context->sharedRing->GetEventFd());
+    }
+    for (int32_t fd : fds) {
+        struct epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(context->epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            SEN_HILOGE("epoll_ctl failed, fd : %{public}d, errno : %{public}d", fd, errno);
+            return ERROR;
+        }
+    }
+    if (context->sharedRing != nullptr) {
+        context->sharedRing->BeginWait();
+    }
+    receiveContext_ = context;
+    receiveThread_ = std::thread(ReceiveThreadTask, context);
+    SEN_HILOGI("receive thread started, priority : %{public}d", receiveThreadAttr_.priority);
+    return ERR_OK;
+}
+
+void SensorDataChannel::StopReceiveThread()
+{
+    if (receiveContext_ == nullptr) {
+        return;
+    }
+    receiveContext_->isStopped.store(true);
+    eventfd_write(receiveContext_->stopFd, 1);
+    if (receiveThread_.get_id() == std::this_thread::get_id()) {
+        // Destroyed from a data callback, the thread leaves its loop once the callback returns
+        receiveThread_.detach();
+    } else if (receiveThread_.joinable()) {
+        receiveThread_.join();
+    }
+    receiveContext_ = nullptr;
+}
+
+void SensorDataChannel::ReceiveThreadTask(std::shared_ptr<ReceiveThreadContext> context)
+{
+    ApplyReceiveThreadAttr(context->attr);
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+    while (!context->isStopped.load()) {
+        int32_t num = epoll_wait(context->epollFd, events, MAX_EPOLL_EVENTS, -1);
+        if (num < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            SEN_HILOGE("epoll_wait failed, errno : %{public}d", errno);
+            break;
+        }
+        // The fds are read right here, no event runner hop between the socket and the data callback
+        for (int32_t i = 0; i < num && !context->isStopped.load(); i++) {
+            if (events[i].data.fd != context->stopFd) {
+                context->listener->OnReadable(events[i].data.fd);
+            }
+        }
+    }
+}
+
+void SensorDataChannel::ApplyReceiveThreadAttr(const SensorReceiveThreadAttr &attr)
+{
+    pthread_setname_np(pthread_self(), "OS_SensorRecv");
+    if (attr.cpuMask != 0) {
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        for (uint32_t cpu = 0; cpu < CPU_MASK_BITS && cpu < CPU_SETSIZE; cpu++) {
+            if ((attr.cpuMask & (1ULL << cpu)) != 0) {
+                CPU_SET(cpu, &cpuSet);
+            }
+        }
+        if (sched_setaffinity(0, sizeof(cpuSet), &cpuSet) != 0) {
+            SEN_HILOGW("set cpu affinity failed, errno : %{public}d", errno);
+        }
+    }
+    if (attr.priority > 0) {
+        struct sched_param param = {};
+        param.sched_priority = attr.priority;
+        int32_t ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (ret != 0) {
+            // Usually missing permission, keep delivering at the normal priority
+            SEN_HILOGW("set SCHED_FIFO priority failed, ret : %{public}d", ret);
+        }
+    }
+}
+
 int32_t SensorDataChannel::DestroySensorDataChannel()
 {
     std::lock_guard<std::mutex> eventRunnerLock(eventRunnerMutex_);
-    CHKPL(eventHandler_);
-    eventHandler_ = nullptr;
+    if (listener_ != nullptr) {
+        // A read loop running on the stack of the unsubscribing callback ends as soon as that callback returns
+        listener_->Stop();
+        listener_ = nullptr;
+    }
+    if (receiveContext_ != nullptr) {
+        StopReceiveThread();
+    } else {
+        CHKPL(eventHandler_);
+        eventHandler_ = nullptr;
+    }
     // destroy sensor basic channelx
     return DestroySensorBasicChannel();
 }
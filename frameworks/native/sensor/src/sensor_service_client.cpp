@@ -124,6 +124,21 @@ int32_t SensorServiceClient::DisableSensor(uint32_t sensorId)
     return ret;
 }
 
+int32_t SensorServiceClient::SetSensorOption(uint32_t sensorId, int32_t option)
+{
+    CALL_LOG_ENTER;
+    if (!IsValidSensorId(sensorId)) {
+        SEN_HILOGE("sensorId is invalid");
+        return SENSOR_NATIVE_SAM_ERR;
+    }
+    int32_t ret = InitServiceClient();
+    if (ret != ERR_OK) {
+        SEN_HILOGE("InitServiceClient failed, ret : %{public}d", ret);
+        return ret;
+    }
+    return sensorServer_->SetSensorOption(sensorId, option);
+}
+
 int32_t SensorServiceClient::RunCommand(uint32_t sensorId, int32_t cmdType, int32_t params)
 {
     CALL_LOG_ENTER;
@@ -194,10 +194,18 @@ ErrCode SensorServiceProxy::TransferDataChannel(const sptr<SensorBasicDataChanne
         SEN_HILOGE("sensorClient failed");
         return WRITE_MSG_ERR;
     }
+    // Offer the newest wire format this client can parse, the service answers with the one it is going to send
+    if (!data.WriteInt32(WIRE_FORMAT_MAX - 1)) {
+        SEN_HILOGE("write wire format failed");
+        return WRITE_MSG_ERR;
+    }
     int32_t ret = Remote()->SendRequest(ISensorService::TRANSFER_DATA_CHANNEL, data, reply, option);
     if (ret != NO_ERROR) {
         DmdReport::ReportException(SENSOR_SERVICE_IPC_EXCEPTION, "TransferDataChannel", ret);
         SEN_HILOGE("failed, ret : %{public}d", ret);
+    } else {
+        // A service without negotiation leaves the reply empty, which reads as the legacy format
+        sensorBasicDataChannel->SetWireFormat(reply.ReadInt32());
     }
     sensorBasicDataChannel->CloseSendFd();
     return static_cast<ErrCode>(ret);
@@ -224,5 +232,30 @@ ErrCode SensorServiceProxy::DestroySensorChannel(sptr<IRemoteObject> sensorClien
     }
     return static_cast<ErrCode>(ret);
 }
+
+ErrCode SensorServiceProxy::SetSensorOption(uint32_t sensorId, int32_t option)
+{
+    MessageParcel data;
+    MessageParcel reply;
+    MessageOption messageOption;
+    if (!data.WriteInterfaceToken(SensorServiceProxy::GetDescriptor())) {
+        SEN_HILOGE("write descriptor failed");
+        return WRITE_MSG_ERR;
+    }
+    if (!data.WriteUint32(sensorId)) {
+        SEN_HILOGE("write sensorId failed");
+        return WRITE_MSG_ERR;
+    }
+    if (!data.WriteInt32(option)) {
+        SEN_HILOGE("write option failed");
+        return WRITE_MSG_ERR;
+    }
+    int32_t ret = Remote()->SendRequest(ISensorService::SET_SENSOR_OPTION, data, reply, messageOption);
+    if (ret != NO_ERROR) {
+        DmdReport::ReportException(SENSOR_SERVICE_IPC_EXCEPTION, "SetSensorOption", ret);
+        SEN_HILOGE("failed, ret : %{public}d", ret);
+    }
+    return static_cast<ErrCode>(ret);
+}
 }  // namespace Sensors
 }  // namespace OHOS
@@ -59,6 +59,7 @@ extern "C" {
 int32_t GetAllSensors(SensorInfo **sensorInfo, int32_t *count);
 /**
  * @brief Subscribes to sensor data. The system will report the obtained sensor data to the subscriber.
+ * Several subscribers in one process can subscribe to the same sensor, they share a single data stream.
  *
  * @param sensorTypeId Indicates the ID of a sensor type. For details, see {@link SensorTypeId}.
  * @param user Indicates the pointer to the sensor subscriber that requests sensor data. For details,
@@ -68,6 +69,57 @@ int32_t GetAllSensors(SensorInfo **sensorInfo, int32_t *count);
  * @since 5
  */
 int32_t SubscribeSensor(int32_t sensorTypeId, const SensorUser *user);
+/**
+ * @brief Subscribes to sensor data in batches. All events of the sensor that arrive in one read are reported
+ * through a single call of <b>batchCallback</b>, so they can be processed as a contiguous array.
+ *
+ * @param sensorTypeId Indicates the ID of a sensor type. For details, see {@link SensorTypeId}.
+ * @param user Indicates the pointer to the batch subscriber that requests sensor data. For details,
+ * see {@link SensorBatchUser}. A subscriber can obtain data from only one sensor.
+ * @return Returns <b>0</b> if the subscription is successful; returns a non-zero value otherwise.
+ *
+ * @since 5
+ */
+int32_t SubscribeSensorBatch(int32_t sensorTypeId, const SensorBatchUser *user);
+/**
+ * @brief Subscribes to sensor data without a callback. Once the sensor is activated, its events are kept in a
+ * buffer of <b>capacity</b> events that is read with {@link ReadSensorEvents} or {@link GetLatestSensorEvent}.
+ *
+ * @param sensorTypeId Indicates the ID of a sensor type. For details, see {@link SensorTypeId}.
+ * @param user Indicates the pointer to the pull subscriber. For details, see {@link SensorPullUser}.
+ * @return Returns <b>0</b> if the subscription is successful; returns a non-zero value otherwise.
+ *
+ * @since 5
+ */
+int32_t SubscribeSensorPull(int32_t sensorTypeId, const SensorPullUser *user);
+/**
+ * @brief Reads the events a pull subscriber has not read yet, oldest first. Events that were overwritten
+ * before they were read are skipped. Reads never block the thread receiving the events and may run on several
+ * threads at once, each event is then returned to exactly one of them.
+ *
+ * @param sensorTypeId Indicates the ID of a sensor type. For details, see {@link SensorTypeId}.
+ * @param user Indicates the pointer to the <b>user</b> member of the activated {@link SensorPullUser}.
+ * @param samples Indicates the array that receives the events.
+ * @param maxCount Indicates the maximum number of events to read.
+ * @param timeoutNs Indicates how long to wait for an event when none is pending, in nanoseconds.
+ * <b>0</b> returns immediately.
+ * @return Returns the number of events read, which is <b>0</b> on timeout; returns a negative value on failure.
+ *
+ * @since 5
+ */
+int32_t ReadSensorEvents(int32_t sensorTypeId, const SensorUser *user, SensorSample *samples, int32_t maxCount,
+    int64_t timeoutNs);
+/**
+ * @brief Gets the newest event of a pull subscriber without consuming it, so it can be called from any thread.
+ *
+ * @param sensorTypeId Indicates the ID of a sensor type. For details, see {@link SensorTypeId}.
+ * @param user Indicates the pointer to the <b>user</b> member of the activated {@link SensorPullUser}.
+ * @param sample Indicates the pointer to the event to fill in.
+ * @return Returns <b>0</b> if an event is available; returns a non-zero value otherwise.
+ *
+ * @since 5
+ */
+int32_t GetLatestSensorEvent(int32_t sensorTypeId, const SensorUser *user, SensorSample *sample);
 /**
  * @brief Unsubscribes from sensor data.
  *
@@ -81,6 +133,8 @@ int32_t SubscribeSensor(int32_t sensorTypeId, const SensorUser *user);
 int32_t UnsubscribeSensor(int32_t sensorTypeId, const SensorUser *user);
 /**
  * @brief Sets the data sampling interval and data reporting interval for the specified sensor.
+ * Every subscriber keeps its own intervals. The sensor runs with the shortest intervals among the enabled
+ * subscribers of the process, and subscribers with a longer sampling interval receive a decimated stream.
  *
  * @param sensorTypeId Indicates the ID of a sensor type. For details, see {@link SensorTypeId}.
  * @param user Indicates the pointer to the sensor subscriber that requests sensor data.
@@ -127,6 +181,33 @@ int32_t DeactivateSensor(int32_t sensorTypeId, const SensorUser *user);
  * @since 5
  */
 int32_t SetMode(int32_t sensorTypeId, const SensorUser *user, int32_t mode);
+/**
+ * @brief Sets an option for the specified sensor subscription.
+ *
+ * @param sensorTypeId Indicates the ID of a sensor type. For details, see {@link SensorTypeId}.
+ * @param user Indicates the pointer to the sensor subscriber that requests sensor data.
+ * For details, see {@link SensorUser}. A subscriber can obtain data from only one sensor.
+ * @param option Indicates the options to set, a combination of {@link SensorOption} flags.
+ * <b>SENSOR_OPTION_DELTA_ENCODING</b> is lossy and only takes effect for sensors that report a resolution.
+ * Options apply to the stream shared by all users of the sensor in this process. Setting an option that differs from
+ * the one of another user fails, and so does subscribing a new user while the sensor is streamed with an option.
+ * @return Returns <b>0</b> if the option is successfully set; returns a non-zero value otherwise.
+ *
+ * @since 5
+ */
+int32_t SetOption(int32_t sensorTypeId, const SensorUser *user, int32_t option);
+/**
+ * @brief Delivers the sensor data of this process on a dedicated thread that reads the data channel directly
+ * instead of through the event runner, so callbacks run without event queueing in between. The setting takes
+ * effect when the data channel is created, it must be made before the first subscription of the process.
+ *
+ * @param attr Indicates the priority and CPU affinity of the receive thread. For details,
+ * see {@link SensorReceiveThreadAttr}. Pass <b>NULL</b> to deliver through the event runner again.
+ * @return Returns <b>0</b> if the setting is successful; returns a non-zero value otherwise.
+ *
+ * @since 5
+ */
+int32_t SetReceiveThread(const SensorReceiveThreadAttr *attr);
 
 #ifdef __cplusplus
 #if __cplusplus
@@ -57,6 +57,10 @@ extern "C" {
 #ifndef VERSION_MAX_LEN
 #define VERSION_MAX_LEN 16
 #endif /* SENSOR_USER_DATA_SIZE */
+/** Maximum length of the data of one pulled sensor sample */
+#ifndef SENSOR_SAMPLE_DATA_MAX_LEN
+#define SENSOR_SAMPLE_DATA_MAX_LEN 64
+#endif /* SENSOR_SAMPLE_DATA_MAX_LEN */
 
 /**
  * @brief Enumerates sensor types.
@@ -128,6 +132,22 @@ typedef struct SensorEvent {
     uint32_t dataLen;      /**< Sensor data length */
 } SensorEvent;
 
+/**
+ * @brief Defines a sensor event returned by the pull interfaces. Unlike {@link SensorEvent} it carries its data
+ * inline, so it stays valid after the call.
+ *
+ * @since 5
+ */
+typedef struct SensorSample {
+    int32_t sensorTypeId;  /**< Sensor type ID */
+    int32_t version;       /**< Sensor algorithm version */
+    int64_t timestamp;     /**< Time when sensor data was reported */
+    uint32_t option;       /**< Sensor data options, including the measurement range and accuracy */
+    int32_t mode;          /**< Sensor data reporting mode (described in {@link SensorMode}) */
+    uint32_t dataLen;      /**< Sensor data length */
+    uint8_t data[SENSOR_SAMPLE_DATA_MAX_LEN];  /**< Sensor data */
+} SensorSample;
+
 /**
  * @brief Defines the callback for data reporting by the sensor agent.
  *
@@ -135,6 +155,14 @@ typedef struct SensorEvent {
  */
 typedef void (*RecordSensorCallback)(SensorEvent *event);
 
+/**
+ * @brief Defines the callback for batched data reporting by the sensor agent. <b>events</b> holds <b>count</b>
+ * events of one sensor in timestamp order, the array and the data it points to are only valid during the call.
+ *
+ * @since 5
+ */
+typedef void (*RecordSensorBatchCallback)(const SensorEvent *events, int32_t count);
+
 /**
  * @brief Defines a reserved field for the sensor data subscriber.
  *
@@ -155,6 +183,28 @@ typedef struct SensorUser {
     UserData *userData;              /**< Reserved field for the sensor data subscriber */
 } SensorUser;
 
+/**
+ * @brief Defines a sensor data subscriber that receives all events of a sensor from one read at once.
+ * Pass <b>&user</b> to the interfaces other than {@link SubscribeSensorBatch}, <b>user.callback</b> is not used.
+ *
+ * @since 5
+ */
+typedef struct SensorBatchUser {
+    SensorUser user;                          /**< Subscriber handle used by the other interfaces */
+    RecordSensorBatchCallback batchCallback;  /**< Callback for reporting a batch of sensor data */
+} SensorBatchUser;
+
+/**
+ * @brief Defines a subscriber that reads sensor data with {@link ReadSensorEvents} and
+ * {@link GetLatestSensorEvent} instead of receiving it through a callback.
+ *
+ * @since 5
+ */
+typedef struct SensorPullUser {
+    SensorUser user;   /**< Subscriber handle used by the other interfaces, its callback is not used */
+    int32_t capacity;  /**< Number of events kept for reading, the oldest ones are overwritten first */
+} SensorPullUser;
+
 /**
  * @brief Enumerates data reporting modes of sensors.
  *
@@ -169,6 +219,29 @@ typedef enum SensorMode {
     SENSOR_MODE_MAX2,        /**< Maximum sensor data reporting mode */
 } SensorMode;
 
+/**
+ * @brief Enumerates the options that can be set for a sensor subscription through {@link SetOption}.
+ * Options are bit flags and can be combined.
+ *
+ * @since 5
+ */
+typedef enum SensorOption {
+    SENSOR_OPTION_DEFAULT = 0,            /**< Samples are picked from the hardware stream as they are */
+    SENSOR_OPTION_ANTI_ALIAS_FILTER = 1,  /**< Hardware stream is low-pass filtered before it is downsampled */
+    SENSOR_OPTION_DELTA_ENCODING = 2,     /**< Batches are sent as deltas quantized to the sensor resolution */
+    SENSOR_OPTION_MAX = 4,                /**< Maximum sensor option */
+} SensorOption;
+
+/**
+ * @brief Defines the dedicated thread that receives the sensor data of a process, see {@link SetReceiveThread}.
+ *
+ * @since 5
+ */
+typedef struct SensorReceiveThreadAttr {
+    int32_t priority;  /**< SCHED_FIFO priority of the thread, <b>0</b> keeps the normal scheduling policy */
+    uint64_t cpuMask;  /**< Bit n allows the thread to run on CPU n, <b>0</b> leaves the placement to the system */
+} SensorReceiveThreadAttr;
+
 /**
  * @brief Defines the accelerometer data structure. Measures the acceleration applied to
  * the device on three physical axes (x, y, and z) in m/s2.
@@ -86,6 +86,17 @@ int32_t SubscribeSensor(int32_t sensorId, const SensorUser *user)
     return proxy->SubscribeSensor(sensorId, user);
 }
 
+int32_t SubscribeSensorBatch(int32_t sensorId, const SensorBatchUser *user)
+{
+    HiLog::Info(LABEL, "%{public}s begin", __func__);
+    const OHOS::Sensors::SensorAgentProxy *proxy = GetInstance();
+    if (proxy == nullptr) {
+        HiLog::Error(LABEL, "%s proxy is nullptr", __func__);
+        return OHOS::Sensors::ERROR;
+    }
+    return proxy->SubscribeSensorBatch(sensorId, user);
+}
+
 int32_t UnsubscribeSensor(int32_t sensorId, const SensorUser *user)
 {
     HiLog::Info(LABEL, "%{public}s begin", __func__);
@@ -117,4 +128,48 @@ int32_t SetOption(int32_t sensorId, const SensorUser *user, int32_t option)
         return OHOS::Sensors::ERROR;
     }
     return proxy->SetOption(sensorId, user, option);
+}
+
+int32_t SetReceiveThread(const SensorReceiveThreadAttr *attr)
+{
+    HiLog::Info(LABEL, "%{public}s begin", __func__);
+    const OHOS::Sensors::SensorAgentProxy *proxy = GetInstance();
+    if (proxy == nullptr) {
+        HiLog::Error(LABEL, "%s proxy is nullptr", __func__);
+        return OHOS::Sensors::ERROR;
+    }
+    return proxy->SetReceiveThread(attr);
+}
+
+int32_t SubscribeSensorPull(int32_t sensorId, const SensorPullUser *user)
+{
+    HiLog::Info(LABEL, "%{public}s begin", __func__);
+    const OHOS::Sensors::SensorAgentProxy *proxy = GetInstance();
+    if (proxy == nullptr) {
+        HiLog::Error(LABEL, "%s proxy is nullptr", __func__);
+        return OHOS::Sensors::ERROR;
+    }
+    return proxy->SubscribeSensorPull(sensorId, user);
+}
+
+int32_t ReadSensorEvents(int32_t sensorId, const SensorUser *user, SensorSample *samples, int32_t maxCount,
+    int64_t timeoutNs)
+{
+    // Polled every frame, resolve the proxy once instead of logging on every call
+    static const OHOS::Sensors::SensorAgentProxy *proxy = GetInstance();
+    if (proxy == nullptr) {
+        HiLog::Error(LABEL, "%s proxy is nullptr", __func__);
+        return OHOS::Sensors::ERROR;
+    }
+    return proxy->ReadSensorEvents(sensorId, user, samples, maxCount, timeoutNs);
+}
+
+int32_t GetLatestSensorEvent(int32_t sensorId, const SensorUser *user, SensorSample *sample)
+{
+    static const OHOS::Sensors::SensorAgentProxy *proxy = GetInstance();
+    if (proxy == nullptr) {
+        HiLog::Error(LABEL, "%s proxy is nullptr", __func__);
+        return OHOS::Sensors::ERROR;
+    }
+    return proxy->GetLatestSensorEvent(sensorId, user, sample);
 }
\ No newline at end of file
@@ -13,8 +13,12 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <atomic>
 #include <gtest/gtest.h>
+#include <limits>
 #include <thread>
+#include <vector>
 
 #include "sensor_agent.h"
 #include "sensors_errors.h"
@@ -27,8 +31,77 @@ using namespace OHOS::HiviewDFX;
 
 namespace {
 constexpr HiLogLabel LABEL = { LOG_CORE, SensorsLogDomain::SENSOR_TEST, "SensorAgentTest" };
+constexpr int64_t DECIMATED_PERIOD_NS = 100000000;
+// Half of the fastest period the test sensor reports at, the jitter a decimated stream may show
+constexpr int64_t PERIOD_TOLERANCE_NS = 5000000;
 }  // namespace
 
+// What a callback saw, updated from whichever thread delivers the data
+struct EventCounter {
+    std::atomic<int32_t> count { 0 };
+    std::atomic<int32_t> emptyCount { 0 };
+    std::atomic<int64_t> lastTimestamp { 0 };
+    std::atomic<int64_t> minInterval { std::numeric_limits<int64_t>::max() };
+    std::atomic<bool> isOrdered { true };
+
+    void Record(const SensorEvent &event)
+    {
+        count++;
+        if (event.data == nullptr || event.dataLen == 0) {
+            emptyCount++;
+        }
+        int64_t last = lastTimestamp.exchange(event.timestamp);
+        if (last == 0) {
+            return;
+        }
+        if (event.timestamp < last) {
+            isOrdered = false;
+        } else if (event.timestamp - last < minInterval.load()) {
+            minInterval.store(event.timestamp - last);
+        }
+    }
+};
+
+// What a batch callback saw, a batch is contiguous when it holds one sensor in timestamp order
+struct BatchCounter {
+    std::atomic<int32_t> batchCount { 0 };
+    std::atomic<int32_t> eventCount { 0 };
+    std::atomic<int64_t> lastTimestamp { 0 };
+    std::atomic<bool> isContiguous { true };
+
+    void Record(const SensorEvent *events, int32_t count)
+    {
+        batchCount++;
+        eventCount += count;
+        for (int32_t i = 1; i < count; i++) {
+            if (events[i].sensorTypeId != events[0].sensorTypeId || events[i].timestamp < events[i - 1].timestamp) {
+                isContiguous = false;
+            }
+        }
+        if (events[0].timestamp < lastTimestamp.exchange(events[count - 1].timestamp)) {
+            isContiguous = false;
+        }
+    }
+};
+
+EventCounter g_filterCounter;
+EventCounter g_deltaCounter;
+BatchCounter g_batchCounter;
+EventCounter g_fastCounter;
+EventCounter g_slowCounter;
+EventCounter g_threadCounter;
+std::atomic<std::thread::id> g_callbackThread;
+EventCounter g_sparseCounter;
+BatchCounter g_mixedBatchCounter;
+EventCounter g_mixedCounter;
+EventCounter g_switchedCounter;
+EventCounter g_selfStopCounter;
+EventCounter g_restartCounter;
+SensorUser g_selfStopUser;
+std::atomic<bool> g_isSelfStopped { false };
+std::atomic<int32_t> g_selfDeactivateRet { -1 };
+std::atomic<int32_t> g_selfUnsubscribeRet { -1 };
+
 class SensorAgentTest : public testing::Test {
 public:
     static void SetUpTestCase();
@@ -60,6 +133,101 @@ void SensorDataCallbackImpl(SensorEvent *event)
 		event[0].sensorTypeId, event[0].version, event[0].dataLen, *(sensorData));
 }
 
+void FilterCallbackImpl(SensorEvent *event)
+{
+    if (event != nullptr) {
+        g_filterCounter.Record(event[0]);
+    }
+}
+
+void DeltaCallbackImpl(SensorEvent *event)
+{
+    if (event != nullptr) {
+        g_deltaCounter.Record(event[0]);
+    }
+}
+
+void FastCallbackImpl(SensorEvent *event)
+{
+    if (event != nullptr) {
+        g_fastCounter.Record(event[0]);
+    }
+}
+
+void SlowCallbackImpl(SensorEvent *event)
+{
+    if (event != nullptr) {
+        g_slowCounter.Record(event[0]);
+    }
+}
+
+void ThreadCallbackImpl(SensorEvent *event)
+{
+    if (event != nullptr) {
+        g_callbackThread.store(std::this_thread::get_id());
+        g_threadCounter.Record(event[0]);
+    }
+}
+
+void SparseCallbackImpl(SensorEvent *event)
+{
+    if (event != nullptr) {
+        g_sparseCounter.Record(event[0]);
+    }
+}
+
+void MixedCallbackImpl(SensorEvent *event)
+{
+    if (event != nullptr) {
+        g_mixedCounter.Record(event[0]);
+    }
+}
+
+void SwitchedCallbackImpl(SensorEvent *event)
+{
+    if (event != nullptr) {
+        g_switchedCounter.Record(event[0]);
+    }
+}
+
+void MixedBatchCallbackImpl(const SensorEvent *events, int32_t count)
+{
+    if (events != nullptr && count > 0) {
+        g_mixedBatchCounter.Record(events, count);
+    }
+}
+
+// Ends its own subscription from the receive thread, which also tears down that thread
+void SelfStopCallbackImpl(SensorEvent *event)
+{
+    if (event == nullptr) {
+        return;
+    }
+    g_selfStopCounter.Record(event[0]);
+    if (!g_isSelfStopped.exchange(true)) {
+        g_selfDeactivateRet.store(DeactivateSensor(0, &g_selfStopUser));
+        g_selfUnsubscribeRet.store(UnsubscribeSensor(0, &g_selfStopUser));
+    }
+}
+
+void RestartCallbackImpl(SensorEvent *event)
+{
+    if (event != nullptr) {
+        g_restartCounter.Record(event[0]);
+    }
+}
+
+void SensorBatchCallbackImpl(const SensorEvent *events, int32_t count)
+{
+    if (events == nullptr || count <= 0) {
+        HiLog::Error(LABEL, "SensorBatchCallbackImpl events is null or count is invalid");
+        return;
+    }
+    HiLog::Info(LABEL, "SensorBatchCallbackImpl sensorTypeId: %{public}d, count: %{public}d",
+        events[0].sensorTypeId, count);
+    g_batchCounter.Record(events, count);
+}
+
 /*
  * Feature: sensor
  * Function: SubscribeSensor
@@ -94,5 +262,604 @@ HWTEST_F(SensorAgentTest, SensorNativeApiTest_001, TestSize.Level1)
     ret = UnsubscribeSensor(sensorTypeId, &user);
     ASSERT_EQ(ret, 0);
 }
+
+/*
+ * Feature: sensor
+ * Function: SetOption
+ * FunctionPoints: Check the interface function
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: Verify the anti-alias filter option of a downsampled subscription.
+ */
+HWTEST_F(SensorAgentTest, SensorNativeApiTest_002, TestSize.Level1)
+{
+    HiLog::Info(LABEL, "%{public}s begin", __func__);
+
+    int32_t sensorTypeId = 0;
+    SensorUser user;
+
+    user.callback = FilterCallbackImpl;
+
+    int32_t ret = SubscribeSensor(sensorTypeId, &user);
+    ASSERT_EQ(ret, 0);
+
+    ret = SetOption(sensorTypeId, &user, SENSOR_OPTION_MAX);
+    ASSERT_NE(ret, 0);
+
+    ret = SetOption(sensorTypeId, &user, SENSOR_OPTION_ANTI_ALIAS_FILTER);
+    ASSERT_EQ(ret, 0);
+
+    ret = SetBatch(sensorTypeId, &user, DECIMATED_PERIOD_NS, 0);
+    ASSERT_EQ(ret, 0);
+
+    ret = ActivateSensor(sensorTypeId, &user);
+    ASSERT_EQ(ret, 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+
+    ret = DeactivateSensor(sensorTypeId, &user);
+    ASSERT_EQ(ret, 0);
+
+    ret = UnsubscribeSensor(sensorTypeId, &user);
+    ASSERT_EQ(ret, 0);
+
+    // The filtered stream still carries every axis and is downsampled to the requested period
+    ASSERT_GT(g_filterCounter.count.load(), 0);
+    ASSERT_EQ(g_filterCounter.emptyCount.load(), 0);
+    ASSERT_TRUE(g_filterCounter.isOrdered.load());
+    ASSERT_GE(g_filterCounter.minInterval.load(), DECIMATED_PERIOD_NS - PERIOD_TOLERANCE_NS);
+}
+
+/*
+ * Feature: sensor
+ * Function: SetOption
+ * FunctionPoints: Check the interface function
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: Verify delta encoded batches combined with the anti-alias filter option.
+ */
+HWTEST_F(SensorAgentTest, SensorNativeApiTest_003, TestSize.Level1)
+{
+    HiLog::Info(LABEL, "%{public}s begin", __func__);
+
+    int32_t sensorTypeId = 0;
+    SensorUser user;
+
+    user.callback = DeltaCallbackImpl;
+
+    int32_t ret = SubscribeSensor(sensorTypeId, &user);
+    ASSERT_EQ(ret, 0);
+
+    ret = SetOption(sensorTypeId, &user, SENSOR_OPTION_ANTI_ALIAS_FILTER | SENSOR_OPTION_DELTA_ENCODING);
+    ASSERT_EQ(ret, 0);
+
+    ret = SetBatch(sensorTypeId, &user, 10000000, 1000000000);
+    ASSERT_EQ(ret, 0);
+
+    ret = ActivateSensor(sensorTypeId, &user);
+    ASSERT_EQ(ret, 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(3000));
+
+    ret = DeactivateSensor(sensorTypeId, &user);
+    ASSERT_EQ(ret, 0);
+
+    ret = UnsubscribeSensor(sensorTypeId, &user);
+    ASSERT_EQ(ret, 0);
+
+    // Decoded delta blocks come out as complete events in their original order
+    ASSERT_GT(g_deltaCounter.count.load(), 0);
+    ASSERT_EQ(g_deltaCounter.emptyCount.load(), 0);
+    ASSERT_TRUE(g_deltaCounter.isOrdered.load());
+}
+
+/*
+ * Feature: sensor
+ * Function: SubscribeSensorBatch
+ * FunctionPoints: Check the interface function
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: Verify that FIFO batches are delivered through the batch callback.
+ */
+HWTEST_F(SensorAgentTest, SensorNativeApiTest_004, TestSize.Level1)
+{
+    HiLog::Info(LABEL, "%{public}s begin", __func__);
+
+    int32_t sensorTypeId = 0;
+    SensorBatchUser batchUser = {};
+
+    int32_t ret = SubscribeSensorBatch(sensorTypeId, &batchUser);
+    ASSERT_NE(ret, 0);
+
+    batchUser.batchCallback = SensorBatchCallbackImpl;
+
+    ret = SubscribeSensorBatch(sensorTypeId, &batchUser);
+    ASSERT_EQ(ret, 0);
+
+    ret = SetBatch(sensorTypeId, &batchUser.user, 10000000, 1000000000);
+    ASSERT_EQ(ret, 0);
+
+    ret = ActivateSensor(sensorTypeId, &batchUser.user);
+    ASSERT_EQ(ret, 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(3000));
+
+    ret = DeactivateSensor(sensorTypeId, &batchUser.user);
+    ASSERT_EQ(ret, 0);
+
+    ret = UnsubscribeSensor(sensorTypeId, &batchUser.user);
+    ASSERT_EQ(ret, 0);
+
+    // Every batch holds at least one event and batches never step back in time
+    ASSERT_GT(g_batchCounter.batchCount.load(), 0);
+    ASSERT_GE(g_batchCounter.eventCount.load(), g_batchCounter.batchCount.load());
+    ASSERT_TRUE(g_batchCounter.isContiguous.load());
+}
+
+/*
+ * Feature: sensor
+ * Function: SubscribeSensor
+ * FunctionPoints: Check the interface function
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: Verify that two users of one process can subscribe to the same sensor at different rates.
+ */
+HWTEST_F(SensorAgentTest, SensorNativeApiTest_005, TestSize.Level1)
+{
+    HiLog::Info(LABEL, "%{public}s begin", __func__);
+
+    int32_t sensorTypeId = 0;
+    SensorUser fastUser;
+    fastUser.callback = FastCallbackImpl;
+    SensorUser slowUser;
+    slowUser.callback = SlowCallbackImpl;
+
+    int32_t ret = SubscribeSensor(sensorTypeId, &fastUser);
+    ASSERT_EQ(ret, 0);
+    ret = SubscribeSensor(sensorTypeId, &slowUser);
+    ASSERT_EQ(ret, 0);
+
+    // Options apply to the stream both users share, one user cannot change it under the other
+    ret = SetOption(sensorTypeId, &fastUser, SENSOR_OPTION_ANTI_ALIAS_FILTER);
+    ASSERT_NE(ret, 0);
+    ret = SetOption(sensorTypeId, &fastUser, SENSOR_OPTION_DEFAULT);
+    ASSERT_EQ(ret, 0);
+
+    ret = SetBatch(sensorTypeId, &fastUser, 10000000, 0);
+    ASSERT_EQ(ret, 0);
+    ret = SetBatch(sensorTypeId, &slowUser, DECIMATED_PERIOD_NS, 0);
+    ASSERT_EQ(ret, 0);
+
+    ret = ActivateSensor(sensorTypeId, &fastUser);
+    ASSERT_EQ(ret, 0);
+    ret = ActivateSensor(sensorTypeId, &slowUser);
+    ASSERT_EQ(ret, 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+
+    ret = DeactivateSensor(sensorTypeId, &fastUser);
+    ASSERT_EQ(ret, 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+
+    ret = UnsubscribeSensor(sensorTypeId, &slowUser);
+    ASSERT_NE(ret, 0);
+    ret = DeactivateSensor(sensorTypeId, &slowUser);
+    ASSERT_EQ(ret, 0);
+
+    ret = UnsubscribeSensor(sensorTypeId, &fastUser);
+    ASSERT_EQ(ret, 0);
+    ret = UnsubscribeSensor(sensorTypeId, &slowUser);
+    ASSERT_EQ(ret, 0);
+
+    // Each user gets its own rate, the slow one is decimated from the stream the fast one drives
+    ASSERT_GT(g_fastCounter.count.load(), 0);
+    ASSERT_GT(g_slowCounter.count.load(), 0);
+    ASSERT_GT(g_fastCounter.count.load(), g_slowCounter.count.load());
+    ASSERT_TRUE(g_slowCounter.isOrdered.load());
+    ASSERT_GE(g_slowCounter.minInterval.load(), DECIMATED_PERIOD_NS - PERIOD_TOLERANCE_NS);
+}
+
+/*
+ * Feature: sensor
+ * Function: SetReceiveThread
+ * FunctionPoints: Check the interface function
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: Verify that sensor data is delivered through a dedicated receive thread.
+ */
+HWTEST_F(SensorAgentTest, SensorNativeApiTest_006, TestSize.Level1)
+{
+    HiLog::Info(LABEL, "%{public}s begin", __func__);
+
+    int32_t sensorTypeId = 0;
+    SensorReceiveThreadAttr attr = { -1, 0 };
+
+    int32_t ret = SetReceiveThread(&attr);
+    ASSERT_NE(ret, 0);
+
+    attr.priority = 0;
+    ret = SetReceiveThread(&attr);
+    ASSERT_EQ(ret, 0);
+
+    SensorUser user;
+    user.callback = ThreadCallbackImpl;
+
+    ret = SubscribeSensor(sensorTypeId, &user);
+    ASSERT_EQ(ret, 0);
+
+    ret = SetReceiveThread(nullptr);
+    ASSERT_NE(ret, 0);
+
+    ret = SetBatch(sensorTypeId, &user, 10000000, 0);
+    ASSERT_EQ(ret, 0);
+
+    ret = ActivateSensor(sensorTypeId, &user);
+    ASSERT_EQ(ret, 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+
+    ret = DeactivateSensor(sensorTypeId, &user);
+    ASSERT_EQ(ret, 0);
+
+    ret = UnsubscribeSensor(sensorTypeId, &user);
+    ASSERT_EQ(ret, 0);
+
+    ret = SetReceiveThread(nullptr);
+    ASSERT_EQ(ret, 0);
+
+    // Callbacks ran on the receive thread, never on the thread that subscribed
+    ASSERT_GT(g_threadCounter.count.load(), 0);
+    ASSERT_TRUE(g_threadCounter.isOrdered.load());
+    ASSERT_NE(g_callbackThread.load(), std::thread::id());
+    ASSERT_NE(g_callbackThread.load(), std::this_thread::get_id());
+}
+
+/*
+ * Feature: sensor
+ * Function: ReadSensorEvents
+ * FunctionPoints: Check the interface function
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: Verify that a pull subscriber reads sensor data without a callback.
+ */
+HWTEST_F(SensorAgentTest, SensorNativeApiTest_007, TestSize.Level1)
+{
+    HiLog::Info(LABEL, "%{public}s begin", __func__);
+
+    int32_t sensorTypeId = 0;
+    SensorPullUser pullUser = {};
+    SensorSample samples[16];
+
+    int32_t ret = SubscribeSensorPull(sensorTypeId, &pullUser);
+    ASSERT_NE(ret, 0);
+
+    pullUser.capacity = 64;
+    ret = SubscribeSensorPull(sensorTypeId, &pullUser);
+    ASSERT_EQ(ret, 0);
+
+    ret = ReadSensorEvents(sensorTypeId, &pullUser.user, samples, 16, 0);
+    ASSERT_LT(ret, 0);
+
+    ret = SetBatch(sensorTypeId, &pullUser.user, 10000000, 0);
+    ASSERT_EQ(ret, 0);
+
+    ret = ActivateSensor(sensorTypeId, &pullUser.user);
+    ASSERT_EQ(ret, 0);
+
+    int32_t count = ReadSensorEvents(sensorTypeId, &pullUser.user, samples, 16, 1000000000);
+    ASSERT_GT(count, 0);
+    for (int32_t i = 0; i < count; i++) {
+        ASSERT_EQ(samples[i].sensorTypeId, sensorTypeId);
+        ASSERT_GT(samples[i].dataLen, 0U);
+        if (i > 0) {
+            ASSERT_GE(samples[i].timestamp, samples[i - 1].timestamp);
+        }
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // Peeking does not consume, the newest event is never older than what was read before
+    SensorSample latest;
+    ret = GetLatestSensorEvent(sensorTypeId, &pullUser.user, &latest);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(latest.sensorTypeId, sensorTypeId);
+    ASSERT_GE(latest.timestamp, samples[count - 1].timestamp);
+
+    ret = ReadSensorEvents(sensorTypeId, &pullUser.user, samples, 16, 0);
+    ASSERT_GT(ret, 0);
+
+    ret = DeactivateSensor(sensorTypeId, &pullUser.user);
+    ASSERT_EQ(ret, 0);
+
+    ret = UnsubscribeSensor(sensorTypeId, &pullUser.user);
+    ASSERT_EQ(ret, 0);
+}
+
+/*
+ * Feature: sensor
+ * Function: ReadSensorEvents
+ * FunctionPoints: Check the interface function
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: Verify that an overrun pull buffer keeps the newest samples and concurrent readers split them.
+ */
+HWTEST_F(SensorAgentTest, SensorNativeApiTest_008, TestSize.Level1)
+{
+    HiLog::Info(LABEL, "%{public}s begin", __func__);
+
+    constexpr int32_t capacity = 4;
+    int32_t sensorTypeId = 0;
+    SensorPullUser pullUser = {};
+    pullUser.capacity = capacity;
+    SensorSample samples[16];
+
+    int32_t ret = SubscribeSensorPull(sensorTypeId, &pullUser);
+    ASSERT_EQ(ret, 0);
+    ret = SetBatch(sensorTypeId, &pullUser.user, 10000000, 0);
+    ASSERT_EQ(ret, 0);
+    ret = ActivateSensor(sensorTypeId, &pullUser.user);
+    ASSERT_EQ(ret, 0);
+
+    // Far more samples than the buffer holds arrive, the writer wraps around and the oldest ones are lost
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    int32_t count = ReadSensorEvents(sensorTypeId, &pullUser.user, samples, 16, 0);
+    ASSERT_GE(count, capacity);
+    for (int32_t i = 1; i < count; i++) {
+        ASSERT_GT(samples[i].timestamp, samples[i - 1].timestamp);
+    }
+    SensorSample latest;
+    ret = GetLatestSensorEvent(sensorTypeId, &pullUser.user, &latest);
+    ASSERT_EQ(ret, 0);
+    ASSERT_GE(latest.timestamp, samples[count - 1].timestamp);
+
+    // Two blocking readers never get the same sample
+    std::vector<int64_t> timestamps[2];
+    auto reader = [&](int32_t index) {
+        SensorSample buffer[capacity];
+        for (int32_t round = 0; round < 20; round++) {
+            int32_t num = ReadSensorEvents(sensorTypeId, &pullUser.user, buffer, capacity, 100000000);
+            for (int32_t i = 0; i < num; i++) {
+                timestamps[index].push_back(buffer[i].timestamp);
+            }
+        }
+    };
+    std::thread first(reader, 0);
+    std::thread second(reader, 1);
+    first.join();
+    second.join();
+    ASSERT_FALSE(timestamps[0].empty() && timestamps[1].empty());
+    for (int64_t timestamp : timestamps[0]) {
+        ASSERT_EQ(std::count(timestamps[1].begin(), timestamps[1].end(), timestamp), 0);
+    }
+
+    ret = DeactivateSensor(sensorTypeId, &pullUser.user);
+    ASSERT_EQ(ret, 0);
+    ret = UnsubscribeSensor(sensorTypeId, &pullUser.user);
+    ASSERT_EQ(ret, 0);
+}
+
+/*
+ * Feature: sensor
+ * Function: SubscribeSensor
+ * FunctionPoints: Check the interface function
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: Verify that subscribing to a huge sensorId does not disturb the dispatch of other sensors.
+ */
+HWTEST_F(SensorAgentTest, SensorNativeApiTest_009, TestSize.Level1)
+{
+    HiLog::Info(LABEL, "%{public}s begin", __func__);
+
+    int32_t sensorTypeId = 0;
+    int32_t hugeSensorTypeId = std::numeric_limits<int32_t>::max();
+    SensorUser hugeUser;
+    hugeUser.callback = SensorDataCallbackImpl;
+    SensorUser user;
+    user.callback = SparseCallbackImpl;
+
+    int32_t ret = SubscribeSensor(hugeSensorTypeId, &hugeUser);
+    ASSERT_EQ(ret, 0);
+    ret = SubscribeSensor(sensorTypeId, &user);
+    ASSERT_EQ(ret, 0);
+    ret = SetBatch(hugeSensorTypeId, &hugeUser, 10000000, 0);
+    ASSERT_EQ(ret, 0);
+    // Whatever the service says about the unknown sensor, publishing the table must stay cheap
+    ActivateSensor(hugeSensorTypeId, &hugeUser);
+    ret = SetBatch(sensorTypeId, &user, 10000000, 0);
+    ASSERT_EQ(ret, 0);
+    ret = ActivateSensor(sensorTypeId, &user);
+    ASSERT_EQ(ret, 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    ret = DeactivateSensor(sensorTypeId, &user);
+    ASSERT_EQ(ret, 0);
+    DeactivateSensor(hugeSensorTypeId, &hugeUser);
+    ret = UnsubscribeSensor(sensorTypeId, &user);
+    ASSERT_EQ(ret, 0);
+    ret = UnsubscribeSensor(hugeSensorTypeId, &hugeUser);
+    ASSERT_EQ(ret, 0);
+
+    ASSERT_GT(g_sparseCounter.count.load(), 0);
+    ASSERT_TRUE(g_sparseCounter.isOrdered.load());
+}
+
+/*
+ * Feature: sensor
+ * Function: SubscribeSensorBatch
+ * FunctionPoints: Check the interface function
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: Verify that a batch user shares a sensor with a per-event user, cannot change the options of the
+ *                  shared stream, and switches to per-event delivery when subscribed again with SubscribeSensor.
+ */
+HWTEST_F(SensorAgentTest, SensorNativeApiTest_010, TestSize.Level1)
+{
+    HiLog::Info(LABEL, "%{public}s begin", __func__);
+
+    int32_t sensorTypeId = 0;
+    SensorBatchUser batchUser = {};
+    batchUser.user.callback = SwitchedCallbackImpl;
+    batchUser.batchCallback = MixedBatchCallbackImpl;
+    SensorUser user;
+    user.callback = MixedCallbackImpl;
+
+    int32_t ret = SubscribeSensorBatch(sensorTypeId, &batchUser);
+    ASSERT_EQ(ret, 0);
+    ret = SubscribeSensor(sensorTypeId, &user);
+    ASSERT_EQ(ret, 0);
+    ret = SetOption(sensorTypeId, &batchUser.user, SENSOR_OPTION_ANTI_ALIAS_FILTER);
+    ASSERT_NE(ret, 0);
+
+    ret = SetBatch(sensorTypeId, &batchUser.user, 10000000, 1000000000);
+    ASSERT_EQ(ret, 0);
+    ret = SetBatch(sensorTypeId, &user, 10000000, 0);
+    ASSERT_EQ(ret, 0);
+    ret = ActivateSensor(sensorTypeId, &batchUser.user);
+    ASSERT_EQ(ret, 0);
+    ret = ActivateSensor(sensorTypeId, &user);
+    ASSERT_EQ(ret, 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+
+    ASSERT_GT(g_mixedBatchCounter.batchCount.load(), 0);
+    ASSERT_GT(g_mixedCounter.count.load(), 0);
+    ASSERT_EQ(g_switchedCounter.count.load(), 0);
+    ret = SubscribeSensor(sensorTypeId, &batchUser.user);
+    ASSERT_EQ(ret, 0);
+    // A read already being dispatched may still hand the old table to the batch callback once
+    int32_t batchCount = g_mixedBatchCounter.batchCount.load();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+
+    ret = DeactivateSensor(sensorTypeId, &batchUser.user);
+    ASSERT_EQ(ret, 0);
+    ret = DeactivateSensor(sensorTypeId, &user);
+    ASSERT_EQ(ret, 0);
+    ret = UnsubscribeSensor(sensorTypeId, &batchUser.user);
+    ASSERT_EQ(ret, 0);
+    ret = UnsubscribeSensor(sensorTypeId, &user);
+    ASSERT_EQ(ret, 0);
+
+    ASSERT_LE(g_mixedBatchCounter.batchCount.load(), batchCount + 1);
+    ASSERT_TRUE(g_mixedBatchCounter.isContiguous.load());
+    ASSERT_GT(g_switchedCounter.count.load(), 0);
+    ASSERT_TRUE(g_switchedCounter.isOrdered.load());
+    ASSERT_TRUE(g_mixedCounter.isOrdered.load());
+}
+
+/*
+ * Feature: sensor
+ * Function: SetReceiveThread
+ * FunctionPoints: Check the interface function
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: Verify that the last user can unsubscribe from a callback running on the receive thread, the
+ *                  thread stops without joining itself and a new subscription afterwards still gets data.
+ */
+HWTEST_F(SensorAgentTest, SensorNativeApiTest_011, TestSize.Level1)
+{
+    HiLog::Info(LABEL, "%{public}s begin", __func__);
+
+    int32_t sensorTypeId = 0;
+    SensorReceiveThreadAttr attr = { 0, 0 };
+    int32_t ret = SetReceiveThread(&attr);
+    ASSERT_EQ(ret, 0);
+
+    g_selfStopUser.callback = SelfStopCallbackImpl;
+    ret = SubscribeSensor(sensorTypeId, &g_selfStopUser);
+    ASSERT_EQ(ret, 0);
+    ret = SetBatch(sensorTypeId, &g_selfStopUser, 10000000, 0);
+    ASSERT_EQ(ret, 0);
+    ret = ActivateSensor(sensorTypeId, &g_selfStopUser);
+    ASSERT_EQ(ret, 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    ASSERT_TRUE(g_isSelfStopped.load());
+    ASSERT_EQ(g_selfDeactivateRet.load(), 0);
+    ASSERT_EQ(g_selfUnsubscribeRet.load(), 0);
+    // Events of the read the callback ran in may still arrive, nothing after it
+    int32_t stopCount = g_selfStopCounter.count.load();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    ASSERT_EQ(g_selfStopCounter.count.load(), stopCount);
+
+    // The channel is gone, so the receive thread may be switched off again
+    ret = SetReceiveThread(nullptr);
+    ASSERT_EQ(ret, 0);
+
+    SensorUser user;
+    user.callback = RestartCallbackImpl;
+    ret = SubscribeSensor(sensorTypeId, &user);
+    ASSERT_EQ(ret, 0);
+    ret = SetBatch(sensorTypeId, &user, 10000000, 0);
+    ASSERT_EQ(ret, 0);
+    ret = ActivateSensor(sensorTypeId, &user);
+    ASSERT_EQ(ret, 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    ret = DeactivateSensor(sensorTypeId, &user);
+    ASSERT_EQ(ret, 0);
+    ret = UnsubscribeSensor(sensorTypeId, &user);
+    ASSERT_EQ(ret, 0);
+
+    ASSERT_GT(g_restartCounter.count.load(), 0);
+    ASSERT_TRUE(g_restartCounter.isOrdered.load());
+}
+
+/*
+ * Feature: sensor
+ * Function: ReadSensorEvents
+ * FunctionPoints: Check the interface function
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: Verify pull reads on invalid arguments, before any data, one sample at a time and after stopping.
+ */
+HWTEST_F(SensorAgentTest, SensorNativeApiTest_012, TestSize.Level1)
+{
+    HiLog::Info(LABEL, "%{public}s begin", __func__);
+
+    int32_t sensorTypeId = 0;
+    SensorPullUser pullUser = {};
+    pullUser.capacity = 64;
+    SensorSample samples[16];
+    SensorSample latest;
+
+    int32_t ret = ReadSensorEvents(sensorTypeId, &pullUser.user, samples, 16, 0);
+    ASSERT_LT(ret, 0);
+    ret = SubscribeSensorPull(sensorTypeId, &pullUser);
+    ASSERT_EQ(ret, 0);
+    ret = SetBatch(sensorTypeId, &pullUser.user, 10000000, 0);
+    ASSERT_EQ(ret, 0);
+    ret = GetLatestSensorEvent(sensorTypeId, &pullUser.user, &latest);
+    ASSERT_NE(ret, 0);
+    ret = ActivateSensor(sensorTypeId, &pullUser.user);
+    ASSERT_EQ(ret, 0);
+
+    ret = ReadSensorEvents(sensorTypeId, &pullUser.user, nullptr, 16, 0);
+    ASSERT_LT(ret, 0);
+    ret = ReadSensorEvents(sensorTypeId, &pullUser.user, samples, 0, 0);
+    ASSERT_LT(ret, 0);
+    ret = ReadSensorEvents(sensorTypeId, &pullUser.user, samples, -1, 0);
+    ASSERT_LT(ret, 0);
+    ret = ReadSensorEvents(sensorTypeId, &pullUser.user, samples, 16, -1);
+    ASSERT_LT(ret, 0);
+    ret = GetLatestSensorEvent(sensorTypeId, &pullUser.user, nullptr);
+    ASSERT_NE(ret, 0);
+
+    // Reading one sample at a time keeps them in order, a drained buffer makes a blocking read wait for the next one
+    int64_t lastTimestamp = 0;
+    for (int32_t i = 0; i < 8; i++) {
+        ret = ReadSensorEvents(sensorTypeId, &pullUser.user, samples, 1, 1000000000);
+        ASSERT_EQ(ret, 1);
+        ASSERT_GE(samples[0].timestamp, lastTimestamp);
+        lastTimestamp = samples[0].timestamp;
+    }
+    while (ReadSensorEvents(sensorTypeId, &pullUser.user, samples, 16, 0) > 0) {}
+    ret = ReadSensorEvents(sensorTypeId, &pullUser.user, samples, 16, 1000000000);
+    ASSERT_GT(ret, 0);
+
+    ret = DeactivateSensor(sensorTypeId, &pullUser.user);
+    ASSERT_EQ(ret, 0);
+    ret = ReadSensorEvents(sensorTypeId, &pullUser.user, samples, 16, 10000000);
+    ASSERT_LT(ret, 0);
+    ret = UnsubscribeSensor(sensorTypeId, &pullUser.user);
+    ASSERT_EQ(ret, 0);
+    ret = ReadSensorEvents(sensorTypeId, &pullUser.user, samples, 16, 0);
+    ASSERT_LT(ret, 0);
+    ret = GetLatestSensorEvent(sensorTypeId, &pullUser.user, &latest);
+    ASSERT_NE(ret, 0);
+}
 }  // namespace Sensors
 }  // namespace OHOS
@@ -50,6 +50,7 @@ public:
 private:
     DISALLOW_COPY_AND_MOVE(CompatibleConnection);
     static int32_t SensorDataCallback(const struct SensorEvents *event);
+    static int32_t SensorDataBatchCallback(const struct SensorEvents *events, int32_t count);
     static ZReportDataCb reportDataCb_;
     static sptr<ReportDataCallback> reportDataCallback_;
     HdiServiceImpl &hdiServiceImpl_ = HdiServiceImpl::GetInstance();
@@ -14,8 +14,8 @@
  */
 #include "compatible_connection.h"
 
+#include <algorithm>
 #include <cstring>
-#include "securec.h"
 #include "sensors_errors.h"
 #include "sensors_log_domain.h"
 
@@ -25,12 +25,11 @@ using namespace OHOS::HiviewDFX;
 
 namespace {
 constexpr HiLogLabel LABEL = { LOG_CORE, SensorsLogDomain::SENSOR_SERVICE, "CompatibleConnection" };
+constexpr int32_t MAX_BATCH_EVENT_COUNT = 100;
 }
 
 ZReportDataCb CompatibleConnection::reportDataCb_ = nullptr;
 sptr<ReportDataCallback> CompatibleConnection::reportDataCallback_ = nullptr;
-std::mutex ISensorHdiConnection::dataMutex_;
-std::condition_variable ISensorHdiConnection::dataCondition_;
 int32_t CompatibleConnection::ConnectHdi()
 {
     SEN_HILOGI("connect hdi success");
@@ -138,17 +137,34 @@ int32_t CompatibleConnection::SensorDataCallback(const struct SensorEvents *even
         .timestamp = event->timestamp,
         .option = event->option,
         .mode = event->mode,
+        .data = event->data,
         .dataLen = event->dataLen
     };
-    sensorEvent.data = new uint8_t[SENSOR_DATA_LENGHT];
-    errno_t ret = memcpy_s(sensorEvent.data, event->dataLen, event->data, event->dataLen);
-    if (ret != EOK) {
-        SEN_HILOGE("copy data failed");
-        delete[] sensorEvent.data;
-        return COPY_ERR;
-    }
     (void)(reportDataCallback_->*reportDataCb_)(&sensorEvent, reportDataCallback_);
-    ISensorHdiConnection::dataCondition_.notify_one();
+    return ERR_OK;
+}
+
+int32_t CompatibleConnection::SensorDataBatchCallback(const struct SensorEvents *events, int32_t count)
+{
+    CHKPR(events, ERR_INVALID_VALUE);
+    CHKPR(reportDataCallback_, ERR_NO_INIT);
+    struct SensorEvent sensorEvents[MAX_BATCH_EVENT_COUNT];
+    for (int32_t begin = 0; begin < count; begin += MAX_BATCH_EVENT_COUNT) {
+        int32_t batchCount = std::min(count - begin, MAX_BATCH_EVENT_COUNT);
+        for (int32_t i = 0; i < batchCount; i++) {
+            const struct SensorEvents &event = events[begin + i];
+            sensorEvents[i] = {
+                .sensorTypeId = event.sensorId,
+                .version = event.version,
+                .timestamp = event.timestamp,
+                .option = event.option,
+                .mode = event.mode,
+                .data = event.data,
+                .dataLen = event.dataLen
+            };
+        }
+        (void)reportDataCallback_->ReportEventsCallback(sensorEvents, batchCount, reportDataCallback_);
+    }
     return ERR_OK;
 }
 
@@ -160,6 +176,11 @@ int32_t CompatibleConnection::RegisteDataReport(ZReportDataCb cb, sptr<ReportDat
         SEN_HILOGE("Register is failed");
         return ret;
     }
+    ret = hdiServiceImpl_.RegisterBatch(SensorDataBatchCallback);
+    if (ret < 0) {
+        SEN_HILOGE("RegisterBatch is failed");
+        return ret;
+    }
     reportDataCb_ = cb;
     reportDataCallback_ = reportDataCallback;
     return ERR_OK;
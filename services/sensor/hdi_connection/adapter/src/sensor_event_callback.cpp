@@ -42,14 +42,12 @@ int32_t SensorEventCallback::OnDataEvent(const HdfSensorEvents& event)
         .timestamp = event.timestamp,
         .option = event.option,
         .mode = event.mode,
-        .dataLen = event.dataLen
+        .data = const_cast<uint8_t *>(event.data.data()),
+        .dataLen = static_cast<uint32_t>(dataSize)
     };
-    sensorEvent.data = new uint8_t[SENSOR_DATA_LENGHT];
-    for (int32_t i = 0; i < static_cast<int32_t>(dataSize); i++) {
-        sensorEvent.data[i] = event.data[i];
-    }
+    // HdfSensorEvents carries exactly one sample and nothing marks the end of a FIFO flush, so there is no batch to
+    // gather here without holding events back until the next one arrives
     (void)(reportDataCallback_->*(reportDataCb_))(&sensorEvent, reportDataCallback_);
-    ISensorHdiConnection::dataCondition_.notify_one();
     return ERR_OK;
 }
 }  // namespace Sensors
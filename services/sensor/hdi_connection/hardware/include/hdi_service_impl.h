@@ -25,6 +25,8 @@
 
 namespace OHOS {
 namespace Sensors {
+using RecordDataBatchCallback = int32_t (*)(const struct SensorEvents *events, int32_t count);
+
 class HdiServiceImpl : public Singleton<HdiServiceImpl> {
 public:
     HdiServiceImpl() = default;
@@ -47,6 +49,8 @@ public:
 
     int32_t Register(RecordDataCallback cb);
 
+    int32_t RegisterBatch(RecordDataBatchCallback cb);
+
     int32_t Unregister();
 
 private:
@@ -55,6 +59,7 @@ private:
     std::vector<int32_t> g_enableSensors;
     std::thread dataReportThread_;
     static RecordDataCallback g_callback;
+    static RecordDataBatchCallback g_batchCallback;
     static int64_t g_samplingInterval;
     static int64_t g_reportInterval;
     static std::atomic_bool g_isStop;
@@ -14,6 +14,8 @@
  */
 #include "hdi_service_impl.h"
 
+#include <algorithm>
+
 #include "sensors_errors.h"
 #include "sensors_log_domain.h"
 #include "unistd.h"
@@ -26,6 +28,7 @@ namespace {
 constexpr HiLogLabel LABEL = { LOG_CORE, SensorsLogDomain::SENSOR_SERVICE, "HdiServiceImpl" };
 constexpr int64_t SAMPLING_INTERVAL_NS = 200000000;
 constexpr int32_t CONVERT_MULTIPLES = 1000;
+constexpr int64_t MAX_FIFO_EVENT_COUNT = 100;
 std::vector<SensorInformation> g_sensorInfos = {
     {"sensor_test", "default", "1.0.0", "1.0.0", 0, 0, 9999.0, 0.000001, 23.0},
 };
@@ -38,6 +41,7 @@ struct SensorEvents testEvent = {
 };
 }
 RecordDataCallback HdiServiceImpl::g_callback;
+RecordDataBatchCallback HdiServiceImpl::g_batchCallback = nullptr;
 int64_t HdiServiceImpl::g_samplingInterval = -1;
 int64_t HdiServiceImpl::g_reportInterval = -1;
 std::atomic_bool HdiServiceImpl::g_isStop = false;
@@ -52,9 +56,26 @@ int32_t HdiServiceImpl::GetSensorList(std::vector<SensorInformation>& sensorList
 void HdiServiceImpl::DataReportThread()
 {
     CALL_LOG_ENTER;
+    std::vector<struct SensorEvents> fifoEvents;
+    fifoEvents.reserve(MAX_FIFO_EVENT_COUNT);
     while (true) {
         usleep(g_samplingInterval / CONVERT_MULTIPLES);
-        g_callback(&testEvent);
+        int64_t fifoCount = (g_samplingInterval > 0) ? (g_reportInterval / g_samplingInterval) : 0;
+        fifoCount = std::min(fifoCount, MAX_FIFO_EVENT_COUNT);
+        if (fifoCount > 1 && g_batchCallback != nullptr) {
+            // Like a hardware fifo, the samples are flushed together once the report delay is reached
+            fifoEvents.push_back(testEvent);
+            if (static_cast<int64_t>(fifoEvents.size()) >= fifoCount) {
+                g_batchCallback(fifoEvents.data(), static_cast<int32_t>(fifoEvents.size()));
+                fifoEvents.clear();
+            }
+        } else {
+            if (!fifoEvents.empty() && g_batchCallback != nullptr) {
+                g_batchCallback(fifoEvents.data(), static_cast<int32_t>(fifoEvents.size()));
+                fifoEvents.clear();
+            }
+            g_callback(&testEvent);
+        }
         if (g_isStop) {
             break;
         }
@@ -145,6 +166,13 @@ int32_t HdiServiceImpl::Register(RecordDataCallback cb)
     return ERR_OK;
 }
 
+int32_t HdiServiceImpl::RegisterBatch(RecordDataBatchCallback cb)
+{
+    CHKPR(cb, ERROR);
+    g_batchCallback = cb;
+    return ERR_OK;
+}
+
 int32_t HdiServiceImpl::Unregister()
 {
     g_isStop = true;
@@ -16,8 +16,6 @@
 #ifndef I_SENSOR_HDI_CONNECTION_H
 #define I_SENSOR_HDI_CONNECTION_H
 
-#include <condition_variable>
-#include <mutex>
 #include "report_data_callback.h"
 #include "sensor.h"
 
@@ -49,10 +47,6 @@ public:
 
     virtual int32_t DestroyHdiConnection() = 0;
 
-    static std::mutex dataMutex_;
-
-    static std::condition_variable dataCondition_;
-
 private:
     DISALLOW_COPY_AND_MOVE(ISensorHdiConnection);
 };
@@ -16,7 +16,9 @@
 #ifndef CLIENT_INFO_H
 #define CLIENT_INFO_H
 
+#include <atomic>
 #include <map>
+#include <memory>
 #include <queue>
 #include <unordered_map>
 #include <vector>
@@ -29,14 +31,43 @@
 #include "nocopyable.h"
 
 #include "app_thread_info.h"
+#include "fifo_cache_data.h"
 #include "sensor_basic_data_channel.h"
+#include "sensor.h"
 #include "sensor_basic_info.h"
 #include "sensor_channel_info.h"
 #include "sensor_agent_type.h"
+#include "sensor_event_ring.h"
 
 namespace OHOS {
 namespace Sensors {
 using Security::AccessToken::AccessTokenID;
+// Everything the dispatcher needs about one subscription, recomputed only when subscriptions change.
+struct SubscriberRecord {
+    sptr<SensorBasicDataChannel> channel;
+    int32_t pid;
+    int32_t uid;
+    AccessTokenID callerToken;
+    uint64_t periodCount;
+    uint64_t fifoCount;
+    int64_t samplingPeriodNs;
+    // Period the hardware samples at, the fastest period requested by any subscriber of the sensor
+    int64_t inputPeriodNs;
+    bool antiAliasFilter;
+    // Sampling and batching state of this (sensor, channel) pair, carried over when the table is rebuilt and
+    // released together with the record once the channel goes away. Only the worker owning the sensor touches it.
+    sptr<FifoCacheData> dispatchState;
+};
+
+/*
+ * Immutable snapshot of the subscribers of every sensor, read by the data dispatcher without locking.
+ * A new snapshot is built and swapped in whenever a subscription or a channel changes.
+ */
+struct DispatchTable {
+    uint64_t version = 0;
+    std::unordered_map<uint32_t, std::vector<SubscriberRecord>> subscribers;
+};
+
 class ClientInfo : public Singleton<ClientInfo> {
 public:
     ClientInfo() = default;
@@ -46,6 +77,7 @@ public:
     SensorBasicInfo GetBestSensorInfo(uint32_t sensorId);
     bool OnlyCurPidSensorEnabled(uint32_t sensorId, int32_t pid);
     std::vector<sptr<SensorBasicDataChannel>> GetSensorChannel(uint32_t sensorId);
+    std::shared_ptr<const DispatchTable> GetDispatchTable() const;
     std::vector<sptr<SensorBasicDataChannel>> GetSensorChannelByUid(int32_t uid);
     sptr<SensorBasicDataChannel> GetSensorChannelByPid(int32_t pid);
     bool UpdateSensorInfo(uint32_t sensorId, int32_t pid, const SensorBasicInfo &sensorInfo);
@@ -57,12 +89,10 @@ public:
     bool DestroySensorChannel(int32_t pid);
     void DestroyAppThreadInfo(int32_t pid);
     SensorBasicInfo GetCurPidSensorInfo(uint32_t sensorId, int32_t pid);
-    uint64_t ComputeBestPeriodCount(uint32_t sensorId, sptr<SensorBasicDataChannel> &channel);
-    uint64_t ComputeBestFifoCount(uint32_t sensorId, sptr<SensorBasicDataChannel> &channel);
-    int32_t GetStoreEvent(int32_t sensorId, struct SensorEvent &event);
-    void StoreEvent(const struct SensorEvent &event);
+    void InitStoredEvents(const std::vector<Sensor> &sensors);
+    int32_t GetStoreEvent(int32_t sensorId, struct TransferSensorEvents &event);
+    void StoreEvent(const struct TransferSensorEvents &event);
     void ClearEvent();
-    AppThreadInfo GetAppInfoByChannel(const sptr<SensorBasicDataChannel> &channel);
     bool SaveClientPid(const sptr<IRemoteObject> &sensorClient, int32_t pid);
     int32_t FindClientPid(const sptr<IRemoteObject> &sensorClient);
     void DestroyClientPid(const sptr<IRemoteObject> &sensorClient);
@@ -70,28 +100,59 @@ public:
     void GetSensorChannelInfo(std::vector<SensorChannelInfo> &channelInfo);
     void UpdateCmd(uint32_t sensorId, int32_t uid, int32_t cmdType);
     void DestroyCmd(int32_t uid);
-    void UpdateDataQueue(int32_t sensorId, struct SensorEvent &event);
-    std::unordered_map<uint32_t, std::queue<struct SensorEvent>> GetDumpQueue();
+    void UpdateSensorOption(uint32_t sensorId, int32_t pid, int32_t option);
+    void ResizeChannelBuffer(int32_t pid);
+    std::unordered_map<uint32_t, std::queue<struct TransferSensorEvents>> GetDumpQueue();
     void ClearDataQueue(int32_t sensorId);
+    void OnPermissionChanged(AccessTokenID callerToken, int32_t sensorTypeId, bool granted);
 
 private:
+    static constexpr uint32_t MAX_DUMP_DATA_SIZE = 10;
+    // Last event of one sensor, guarded by a sequence lock so readers never block the data dispatcher.
+    struct alignas(CACHE_LINE_SIZE) StoredEventSlot {
+        std::atomic<uint32_t> sequence { 0 };
+        bool hasEvent = false;
+        struct TransferSensorEvents event;
+        // Latest events kept for dump, historyCount of them are valid starting with the oldest at historyHead
+        struct TransferSensorEvents history[MAX_DUMP_DATA_SIZE];
+        uint32_t historyHead = 0;
+        uint32_t historyCount = 0;
+    };
+    // Slot array and its sensor index, replaced as a whole so the data path never sees a half-built table.
+    struct StoredEventTable {
+        std::unordered_map<uint32_t, uint32_t> index;
+        std::unique_ptr<StoredEventSlot[]> slots;
+    };
     DISALLOW_COPY_AND_MOVE(ClientInfo);
     int32_t GetUidByPid(int32_t pid);
+    void ClearDeltaEncoding(uint32_t sensorId, int32_t pid);
     std::vector<int32_t> GetCmdList(uint32_t sensorId, int32_t uid);
+    void PublishDispatchTable();
+    void BuildSubscribers(uint32_t sensorId, const std::unordered_map<int32_t, SensorBasicInfo> &pidMap,
+                          const DispatchTable &lastTable, std::vector<SubscriberRecord> &subscribers,
+                          std::vector<std::pair<AccessTokenID, uint32_t>> &unverified);
+    sptr<FifoCacheData> FindDispatchState(uint32_t sensorId, const sptr<SensorBasicDataChannel> &channel,
+                                          const DispatchTable &lastTable);
+    StoredEventSlot *FindStoredEventSlot(uint32_t sensorId, std::shared_ptr<const StoredEventTable> &table);
+    uint32_t BeginStoredEventWrite(StoredEventSlot &slot);
+    void WriteStoredEvent(StoredEventSlot &slot, const struct TransferSensorEvents *event);
     std::mutex clientMutex_;
     std::mutex channelMutex_;
-    std::mutex eventMutex_;
     std::mutex uidMutex_;
     std::mutex clientPidMutex_;
     std::mutex cmdMutex_;
-    std::mutex dataQueueMutex_;
+    std::mutex dispatchMutex_;
     std::unordered_map<uint32_t, std::unordered_map<int32_t, SensorBasicInfo>> clientMap_;
+    // Options set per sensor and pid through SetOption, guarded by clientMutex_
+    std::unordered_map<uint32_t, std::unordered_map<int32_t, int32_t>> optionMap_;
     std::unordered_map<int32_t, sptr<SensorBasicDataChannel>> channelMap_;
-    std::unordered_map<int32_t, struct SensorEvent> storedEvent_;
+    // Published with std::atomic_store and read with std::atomic_load
+    std::shared_ptr<const StoredEventTable> storedEvents_;
     std::unordered_map<int32_t, AppThreadInfo> appThreadInfoMap_;
     std::map<sptr<IRemoteObject>, int32_t> clientPidMap_;
     std::unordered_map<uint32_t, std::unordered_map<int32_t, std::vector<int32_t>>> cmdMap_;
-    std::unordered_map<uint32_t, std::queue<struct SensorEvent>> dumpQueue_;
+    uint64_t dispatchVersion_ = 0;
+    std::shared_ptr<const DispatchTable> dispatchTable_ = std::make_shared<const DispatchTable>();
 };
 }  // namespace Sensors
 }  // namespace OHOS
@@ -16,6 +16,7 @@
 #ifndef FIFO_CACHE_DATA_H
 #define FIFO_CACHE_DATA_H
 
+#include <memory>
 #include <vector>
 
 #include "refbase.h"
@@ -23,6 +24,7 @@
 
 #include "sensor_agent_type.h"
 #include "sensor_basic_data_channel.h"
+#include "sensor_low_pass_filter.h"
 
 namespace OHOS {
 namespace Sensors {
@@ -30,19 +32,29 @@ class FifoCacheData : public RefBase {
 public:
     FifoCacheData();
     virtual ~FifoCacheData();
-    void SetPeriodCount(uint64_t periodCount);
-    uint64_t GetPeriodCount() const;
-    void SetFifoCacheData(const std::vector<struct SensorEvent> &fifoCacheData);
-    std::vector<struct SensorEvent> GetFifoCacheData() const;
+    bool IsSampleDue(int64_t timestamp, int64_t samplingPeriodNs, int64_t toleranceNs);
+    const struct TransferSensorEvents *FilterSample(const struct TransferSensorEvents &event, int64_t inputPeriodNs,
+        int64_t outputPeriodNs);
+    void ReserveFifoCache(uint64_t fifoCount);
+    bool AppendFifoCacheData(const struct TransferSensorEvents &event);
+    const struct TransferSensorEvents *GetFifoCacheBuffer() const;
+    size_t GetFifoCacheSize() const;
     void SetChannel(const sptr<SensorBasicDataChannel> &channel);
     sptr<SensorBasicDataChannel> GetChannel() const;
     void InitFifoCache();
+    int64_t &GetGrantExpiry();
 
 private:
     DISALLOW_COPY_AND_MOVE(FifoCacheData);
-    uint64_t periodCount_;
+    int64_t nextDueTimestamp_;
+    // Until then the permission of the subscriber is taken as granted without asking PermissionUtil
+    int64_t grantExpiry_;
     sptr<SensorBasicDataChannel> channel_;
-    std::vector<struct SensorEvent> fifoCacheData_;
+    // Preallocated batch storage, only the first fifoSize_ entries are valid
+    std::vector<struct TransferSensorEvents> fifoCacheData_;
+    size_t fifoCapacity_;
+    size_t fifoSize_;
+    std::unique_ptr<SensorLowPassFilter> filter_;
 };
 }  // namespace Sensors
 }  // namespace OHOS
@@ -16,6 +16,7 @@
 #ifndef FLUSH_INFO_RECORD_H
 #define FLUSH_INFO_RECORD_H
 
+#include <memory>
 #include <mutex>
 #include <unordered_map>
 #include <vector>
@@ -40,6 +41,8 @@ struct FlushInfo {
         : flushChannel(channel), flushFromEnable(enableFlush){};
 };
 
+using FlushInfoMap = std::unordered_map<uint32_t, std::vector<struct FlushInfo>>;
+
 class FlushInfoRecord : public Singleton<FlushInfoRecord> {
 public:
     FlushInfoRecord() = default;
@@ -48,22 +51,25 @@ public:
         flushInfo_.clear();
     }
 
-    std::unordered_map<uint32_t, std::vector<struct FlushInfo>> GetFlushInfo();
+    std::shared_ptr<const FlushInfoMap> GetFlushInfo() const;
     void ClearFlushInfoItem(uint32_t sensorId);
     ErrCode SetFlushInfo(uint32_t sensorId, const sptr<SensorBasicDataChannel> &channel, bool isFirstFlush);
-    bool IsFlushChannelValid(const std::vector<sptr<SensorBasicDataChannel>> &currChannelList,
-                           const sptr<SensorBasicDataChannel> &flushChannel);
+    const SubscriberRecord *FindFlushSubscriber(const std::vector<SubscriberRecord> &subscribers,
+                                                const sptr<SensorBasicDataChannel> &flushChannel);
     int32_t GetFlushChannelIndex(const std::vector<struct FlushInfo> &flushInfoList,
                            const sptr<SensorBasicDataChannel> &channel);
     ErrCode FlushProcess(const uint32_t sensorId, const uint32_t flag, const int32_t pid, const bool isEnableFlush);
 
 private:
     DISALLOW_COPY_AND_MOVE(FlushInfoRecord);
+    void PublishFlushInfo();
     SensorHdiConnection &sensorHdiConnection_ = SensorHdiConnection::GetInstance();
     ClientInfo &clientInfo_ = ClientInfo::GetInstance();
     // sensorId, channel pointer for pending flush.
-    std::unordered_map<uint32_t, std::vector<struct FlushInfo>> flushInfo_;
+    FlushInfoMap flushInfo_;
     std::mutex flushInfoMutex_;
+    // Copy of flushInfo_ published on every change, read by the data dispatcher without locking.
+    std::shared_ptr<const FlushInfoMap> flushInfoSnapshot_ = std::make_shared<const FlushInfoMap>();
 };
 }  // namespace Sensors
 }  // namespace OHOS
@@ -36,33 +36,52 @@ namespace OHOS {
 namespace Sensors {
 class SensorDataProcesser : public RefBase {
 public:
+    struct ChannelOutbox {
+        sptr<SensorBasicDataChannel> channel;
+        std::vector<struct TransferSensorEvents> events;
+    };
+    // Owned by one dispatcher worker, entries and their buffers are reused across drains
+    struct DispatchOutbox {
+        std::vector<ChannelOutbox> entries;
+        size_t count = 0;
+    };
     explicit SensorDataProcesser(const std::unordered_map<uint32_t, Sensor> &sensorMap);
     virtual ~SensorDataProcesser();
-    int32_t ProcessEvents(sptr<ReportDataCallback> dataCallback);
-    int32_t SendEvents(sptr<SensorBasicDataChannel> &channel, struct SensorEvent &event);
-    static int DataThread(sptr<SensorDataProcesser> dataProcesser, sptr<ReportDataCallback> dataCallback);
-    int32_t CacheSensorEvent(const struct SensorEvent &event, sptr<SensorBasicDataChannel> &channel);
+    int32_t ProcessEvents(sptr<ReportDataCallback> dataCallback, uint32_t ringIndex, DispatchOutbox &outbox);
+    int32_t SendEvents(const SubscriberRecord &subscriber, struct TransferSensorEvents &event,
+        DispatchOutbox &outbox);
+    static int DataThread(sptr<SensorDataProcesser> dataProcesser, sptr<ReportDataCallback> dataCallback,
+        uint32_t ringIndex, int32_t cpuId);
+    static int32_t BacklogThread(sptr<SensorDataProcesser> dataProcesser);
 
 private:
     DISALLOW_COPY_AND_MOVE(SensorDataProcesser);
-    void ReportData(sptr<SensorBasicDataChannel> &channel, struct SensorEvent &event);
-    bool ReportNotContinuousData(std::unordered_map<uint32_t, struct SensorEvent> &cacheBuf,
-                                 sptr<SensorBasicDataChannel> &channel, struct SensorEvent &event);
-    void SendNoneFifoCacheData(std::unordered_map<uint32_t, struct SensorEvent> &cacheBuf,
-                               sptr<SensorBasicDataChannel> &channel, struct SensorEvent &event, uint64_t periodCount);
-    void SendFifoCacheData(std::unordered_map<uint32_t, struct SensorEvent> &cacheBuf,
-                           sptr<SensorBasicDataChannel> &channel, struct SensorEvent &event, uint64_t periodCount,
-                           uint64_t fifoCount);
-    void SendRawData(std::unordered_map<uint32_t, struct SensorEvent> &cacheBuf, sptr<SensorBasicDataChannel> channel,
-                     std::vector<struct SensorEvent> event);
-    void EventFilter(struct CircularEventBuf &eventsBuf);
-    bool CheckSendDataPermission(sptr<SensorBasicDataChannel> channel, uint32_t sensorId);
+    void ReportData(const SubscriberRecord &subscriber, struct TransferSensorEvents &event, DispatchOutbox &outbox);
+    bool RenewPermission(const SubscriberRecord &subscriber, int32_t sensorTypeId);
+    bool ReportNotContinuousData(const SubscriberRecord &subscriber, struct TransferSensorEvents &event,
+        DispatchOutbox &outbox);
+    void SendNoneFifoCacheData(const SubscriberRecord &subscriber, struct TransferSensorEvents &event,
+        DispatchOutbox &outbox);
+    void SendFifoCacheData(const SubscriberRecord &subscriber, struct TransferSensorEvents &event,
+        DispatchOutbox &outbox);
+    void SendRawData(const SubscriberRecord &subscriber, const struct TransferSensorEvents *events, size_t eventNum,
+        DispatchOutbox &outbox);
+    void FlushOutbox(DispatchOutbox &outbox);
+    void WatchBacklog(const sptr<SensorBasicDataChannel> &channel);
+    void DrainBacklog(int32_t sendFd);
+    void SweepBacklogChannels();
+    const struct TransferSensorEvents *DecimateEvent(const SubscriberRecord &subscriber,
+        const struct TransferSensorEvents &event);
+    bool ConvertToTransferEvent(const struct SensorEvent &event, struct TransferSensorEvents &transferEvent);
+    void EventFilter(struct SensorEvent &event, DispatchOutbox &outbox);
     ClientInfo &clientInfo_ = ClientInfo::GetInstance();
     FlushInfoRecord &flushInfo_ = FlushInfoRecord::GetInstance();
-    std::mutex dataCountMutex_;
-    std::unordered_map<uint32_t, std::vector<sptr<FifoCacheData>>> dataCountMap_;
-    std::mutex sensorMutex_;
+    // Read only once constructed
     std::unordered_map<uint32_t, Sensor> sensorMap_;
+    // Channels whose socket was full, drained by BacklogThread once epoll reports them writable again
+    int32_t backlogEpollFd_ = -1;
+    std::mutex backlogMutex_;
+    std::unordered_map<int32_t, wptr<SensorBasicDataChannel>> backlogChannels_;
 };
 }  // namespace Sensors
 }  // namespace OHOS
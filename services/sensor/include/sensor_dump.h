@@ -23,6 +23,7 @@
 #include "nocopyable.h"
 
 #include "client_info.h"
+#include "report_data_callback.h"
 #include "sensor.h"
 #include "sensor_agent_type.h"
 
@@ -39,12 +40,13 @@ public:
     bool DumpOpeningSensor(int32_t fd, const std::vector<Sensor> &sensors, ClientInfo &clientInfo,
                            const std::vector<std::u16string> &args);
     bool DumpSensorData(int32_t fd, ClientInfo &clientInfo, const std::vector<std::u16string> &args);
+    bool DumpDataPath(int32_t fd, sptr<ReportDataCallback> dataCallback, const std::vector<std::u16string> &args);
 
 private:
     DISALLOW_COPY_AND_MOVE(SensorDump);
     void DumpCurrentTime(int32_t fd);
     int32_t DataSizeBySensorId(uint32_t sensorId);
-    std::string GetDataBySensorId(uint32_t sensorId, struct SensorEvent &sensorData);
+    std::string GetDataBySensorId(uint32_t sensorId, struct TransferSensorEvents &sensorData);
     static std::unordered_map<uint32_t, std::string> sensorMap_;
 };
 }  // namespace Sensors
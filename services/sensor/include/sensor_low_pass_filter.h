@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SENSOR_LOW_PASS_FILTER_H
+#define SENSOR_LOW_PASS_FILTER_H
+
+#include "nocopyable.h"
+
+#include "sensor_basic_data_channel.h"
+
+namespace OHOS {
+namespace Sensors {
+/*
+ * Second order Butterworth low-pass applied to every float axis of a sensor event before it is downsampled.
+ * It runs at the hardware rate with its cutoff placed below the Nyquist frequency of the subscriber rate,
+ * so vibration above the delivered rate is removed instead of folding back into the low-rate stream.
+ */
+class SensorLowPassFilter {
+public:
+    SensorLowPassFilter() = default;
+    ~SensorLowPassFilter() = default;
+    void Configure(int64_t inputPeriodNs, int64_t outputPeriodNs);
+    void Update(const struct TransferSensorEvents &event);
+    const struct TransferSensorEvents &GetOutput() const;
+
+private:
+    DISALLOW_COPY_AND_MOVE(SensorLowPassFilter);
+    static constexpr size_t MAX_AXIS_COUNT = SENSOR_MAX_LENGTH / sizeof(float);
+    void Reset(const float *input, size_t axisCount);
+    int64_t inputPeriodNs_ = 0;
+    int64_t outputPeriodNs_ = 0;
+    float b0_ = 1.0f;
+    float b1_ = 0.0f;
+    float b2_ = 0.0f;
+    float a1_ = 0.0f;
+    float a2_ = 0.0f;
+    size_t axisCount_ = 0;
+    bool primed_ = false;
+    float z1_[MAX_AXIS_COUNT] = {};
+    float z2_[MAX_AXIS_COUNT] = {};
+    struct TransferSensorEvents output_ = {};
+};
+}  // namespace Sensors
+}  // namespace OHOS
+#endif  // SENSOR_LOW_PASS_FILTER_H
@@ -19,6 +19,7 @@
 #include <mutex>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "client_info.h"
 #include "flush_info_record.h"
@@ -45,7 +46,7 @@ public:
 private:
     SensorHdiConnection &sensorHdiConnection_ = SensorHdiConnection::GetInstance();
     ClientInfo &clientInfo_ = ClientInfo::GetInstance();
-    std::thread dataThread_;
+    std::vector<std::thread> dataThreads_;
     sptr<SensorDataProcesser> sensorDataProcesser_;
     sptr<ReportDataCallback> reportDataCallback_;
     std::unordered_map<uint32_t, Sensor> sensorMap_;
@@ -68,6 +68,8 @@ public:
 
     ErrCode DestroySensorChannel(sptr<IRemoteObject> sensorClient) override;
 
+    ErrCode SetSensorOption(uint32_t sensorId, int32_t option) override;
+
     void ProcessDeathObserver(const wptr<IRemoteObject> &object);
 
 private:
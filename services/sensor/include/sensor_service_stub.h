@@ -42,6 +42,7 @@ private:
     ErrCode GetAllSensorsInner(MessageParcel &data, MessageParcel &reply);
     ErrCode CreateDataChannelInner(MessageParcel &data, MessageParcel &reply);
     ErrCode DestroyDataChannelInner(MessageParcel &data, MessageParcel &reply);
+    ErrCode SetSensorOptionInner(MessageParcel &data, MessageParcel &reply);
     std::unordered_map<uint32_t, SensorBaseFunc> baseFuncs_;
 };
 }  // namespace Sensors
@@ -15,10 +15,10 @@
 
 #include "client_info.h"
 
+#include <algorithm>
 #include <mutex>
 
 #include "securec.h"
-#include "sensor_hdi_connection.h"
 #include "sensors_errors.h"
 #include "sensors_log_domain.h"
 
@@ -36,8 +36,9 @@ constexpr int32_t INVALID_UID = -1;
 constexpr int32_t MIN_MAP_SIZE = 0;
 constexpr uint32_t NO_STROE_EVENT = -2;
 constexpr uint32_t MAX_SUPPORT_CHANNEL = 200;
-constexpr uint32_t MAX_DUMP_DATA_SIZE = 10;
 constexpr uint32_t HEART_RATE_SENSOR_ID = 83886336;
+// How long a client may take to get to its socket before events have to queue in the backlog
+constexpr int64_t CHANNEL_DRAIN_WINDOW_NS = 100000000;
 }  // namespace
 
 bool ClientInfo::GetSensorState(uint32_t sensorId)
@@ -128,19 +129,23 @@ bool ClientInfo::UpdateAppThreadInfo(int32_t pid, int32_t uid, AccessTokenID cal
         SEN_HILOGE("uid or pid is invalid");
         return false;
     }
-    std::lock_guard<std::mutex> uidLock(uidMutex_);
-    AppThreadInfo appThreadInfo(pid, uid, callerToken);
-    auto appThreadInfoItr = appThreadInfoMap_.find(pid);
-    if (appThreadInfoItr == appThreadInfoMap_.end()) {
-        if (appThreadInfoMap_.size() == MAX_SUPPORT_CHANNEL) {
-            SEN_HILOGE("max support channel size is %{public}u", MAX_SUPPORT_CHANNEL);
-            return false;
+    bool ret = true;
+    {
+        std::lock_guard<std::mutex> uidLock(uidMutex_);
+        AppThreadInfo appThreadInfo(pid, uid, callerToken);
+        auto appThreadInfoItr = appThreadInfoMap_.find(pid);
+        if (appThreadInfoItr == appThreadInfoMap_.end()) {
+            if (appThreadInfoMap_.size() == MAX_SUPPORT_CHANNEL) {
+                SEN_HILOGE("max support channel size is %{public}u", MAX_SUPPORT_CHANNEL);
+                return false;
+            }
+            ret = appThreadInfoMap_.insert(std::make_pair(pid, appThreadInfo)).second;
+        } else {
+            appThreadInfoMap_[pid] = appThreadInfo;
         }
-        auto ret = appThreadInfoMap_.insert(std::make_pair(pid, appThreadInfo));
-        return ret.second;
     }
-    appThreadInfoMap_[pid] = appThreadInfo;
-    return true;
+    PublishDispatchTable();
+    return ret;
 }
 
 void ClientInfo::DestroyAppThreadInfo(int32_t pid)
@@ -223,6 +228,120 @@ std::vector<sptr<SensorBasicDataChannel>> ClientInfo::GetSensorChannel(uint32_t
     return sensorChannel;
 }
 
+std::shared_ptr<const DispatchTable> ClientInfo::GetDispatchTable() const
+{
+    return std::atomic_load(&dispatchTable_);
+}
+
+void ClientInfo::PublishDispatchTable()
+{
+    std::vector<std::pair<AccessTokenID, uint32_t>> unverified;
+    while (true) {
+        // Permissions missing from the cache are verified without holding any lock of ClientInfo, then the table
+        // is built again from the filled cache
+        for (const auto &permission : unverified) {
+            PermissionUtil::GetInstance().CheckSensorPermission(permission.first,
+                static_cast<int32_t>(permission.second));
+        }
+        unverified.clear();
+        std::lock_guard<std::mutex> dispatchLock(dispatchMutex_);
+        auto dispatchTable = std::make_shared<DispatchTable>();
+        auto lastTable = std::atomic_load(&dispatchTable_);
+        {
+            std::lock_guard<std::mutex> clientLock(clientMutex_);
+            std::lock_guard<std::mutex> uidLock(uidMutex_);
+            std::lock_guard<std::mutex> channelLock(channelMutex_);
+            for (const auto &clientIt : clientMap_) {
+                std::vector<SubscriberRecord> subscribers;
+                BuildSubscribers(clientIt.first, clientIt.second, *lastTable, subscribers, unverified);
+                if (!subscribers.empty()) {
+                    dispatchTable->subscribers.insert(std::make_pair(clientIt.first, std::move(subscribers)));
+                }
+            }
+        }
+        if (!unverified.empty()) {
+            continue;
+        }
+        dispatchTable->version = ++dispatchVersion_;
+        std::atomic_store(&dispatchTable_, std::shared_ptr<const DispatchTable>(std::move(dispatchTable)));
+        return;
+    }
+}
+
+sptr<FifoCacheData> ClientInfo::FindDispatchState(uint32_t sensorId, const sptr<SensorBasicDataChannel> &channel,
+                                                  const DispatchTable &lastTable)
+{
+    auto subscribersIt = lastTable.subscribers.find(sensorId);
+    if (subscribersIt == lastTable.subscribers.end()) {
+        return nullptr;
+    }
+    for (const auto &subscriber : subscribersIt->second) {
+        if (subscriber.channel == channel) {
+            return subscriber.dispatchState;
+        }
+    }
+    return nullptr;
+}
+
+void ClientInfo::BuildSubscribers(uint32_t sensorId, const std::unordered_map<int32_t, SensorBasicInfo> &pidMap,
+                                  const DispatchTable &lastTable, std::vector<SubscriberRecord> &subscribers,
+                                  std::vector<std::pair<AccessTokenID, uint32_t>> &unverified)
+{
+    int64_t bestSamplingPeriod = LLONG_MAX;
+    for (const auto &sensorInfoIt : pidMap) {
+        bestSamplingPeriod = std::min(bestSamplingPeriod, sensorInfoIt.second.GetSamplingPeriodNs());
+    }
+    for (const auto &sensorInfoIt : pidMap) {
+        auto channelIt = channelMap_.find(sensorInfoIt.first);
+        if (channelIt == channelMap_.end()) {
+            continue;
+        }
+        SubscriberRecord subscriber = {
+            channelIt->second, sensorInfoIt.first, 0, 0, 0UL, 0UL, 0L, 0L, false, nullptr
+        };
+        auto appThreadInfoIt = appThreadInfoMap_.find(sensorInfoIt.first);
+        if (appThreadInfoIt != appThreadInfoMap_.end()) {
+            subscriber.uid = appThreadInfoIt->second.uid;
+            subscriber.callerToken = appThreadInfoIt->second.callerToken;
+        }
+        // Denied subscribers are left out, the data path only ever sees subscribers that may get the data
+        bool granted = false;
+        if (!PermissionUtil::GetInstance().PeekSensorPermission(subscriber.callerToken,
+            static_cast<int32_t>(sensorId), granted)) {
+            unverified.push_back(std::make_pair(subscriber.callerToken, sensorId));
+            continue;
+        }
+        if (!granted) {
+            continue;
+        }
+        int64_t curSamplingPeriod = sensorInfoIt.second.GetSamplingPeriodNs();
+        int64_t curReportDelay = sensorInfoIt.second.GetMaxReportDelayNs();
+        if (bestSamplingPeriod > 0L && curSamplingPeriod > 0L) {
+            subscriber.periodCount = static_cast<uint64_t>(curSamplingPeriod / bestSamplingPeriod);
+            subscriber.samplingPeriodNs = curSamplingPeriod;
+            subscriber.inputPeriodNs = bestSamplingPeriod;
+        }
+        auto optionIt = optionMap_.find(sensorId);
+        if (optionIt != optionMap_.end()) {
+            auto pidOptionIt = optionIt->second.find(sensorInfoIt.first);
+            subscriber.antiAliasFilter = (pidOptionIt != optionIt->second.end()) &&
+                ((static_cast<uint32_t>(pidOptionIt->second) & SENSOR_OPTION_ANTI_ALIAS_FILTER) != 0);
+        }
+        if (curSamplingPeriod > 0L && curReportDelay > 0L) {
+            subscriber.fifoCount = static_cast<uint64_t>(curReportDelay / curSamplingPeriod);
+        }
+        subscriber.dispatchState = FindDispatchState(sensorId, subscriber.channel, lastTable);
+        if (subscriber.dispatchState == nullptr) {
+            subscriber.dispatchState = new (std::nothrow) FifoCacheData();
+            if (subscriber.dispatchState == nullptr) {
+                SEN_HILOGE("alloc dispatch state failed, sensorId : %{public}u", sensorId);
+                continue;
+            }
+        }
+        subscribers.push_back(subscriber);
+    }
+}
+
 bool ClientInfo::UpdateSensorInfo(uint32_t sensorId, int32_t pid, const SensorBasicInfo &sensorInfo)
 {
     CALL_LOG_ENTER;
@@ -230,35 +349,40 @@ bool ClientInfo::UpdateSensorInfo(uint32_t sensorId, int32_t pid, const SensorBa
         SEN_HILOGE("params are invalid");
         return false;
     }
-    std::lock_guard<std::mutex> clientLock(clientMutex_);
-    auto it = clientMap_.find(sensorId);
-    if (it == clientMap_.end()) {
-        std::unordered_map<int32_t, SensorBasicInfo> pidMap;
-        auto pidRet = pidMap.insert(std::make_pair(pid, sensorInfo));
-        auto clientRet = clientMap_.insert(std::make_pair(sensorId, pidMap));
-        return pidRet.second && clientRet.second;
-    }
-    auto pidIt = it->second.find(pid);
-    if (pidIt == it->second.end()) {
-        auto ret = it->second.insert(std::make_pair(pid, sensorInfo));
-        return ret.second;
+    bool ret = true;
+    {
+        std::lock_guard<std::mutex> clientLock(clientMutex_);
+        auto it = clientMap_.find(sensorId);
+        if (it == clientMap_.end()) {
+            std::unordered_map<int32_t, SensorBasicInfo> pidMap;
+            auto pidRet = pidMap.insert(std::make_pair(pid, sensorInfo));
+            auto clientRet = clientMap_.insert(std::make_pair(sensorId, pidMap));
+            ret = pidRet.second && clientRet.second;
+        } else {
+            it->second[pid] = sensorInfo;
+        }
     }
-    it->second[pid] = sensorInfo;
-    return true;
+    PublishDispatchTable();
+    return ret;
 }
 
 void ClientInfo::RemoveSubscriber(uint32_t sensorId, uint32_t pid)
 {
-    std::lock_guard<std::mutex> clientLock(clientMutex_);
-    auto it = clientMap_.find(sensorId);
-    if (it == clientMap_.end()) {
-        SEN_HILOGW("sensorId not exist");
-        return;
-    }
-    auto pidIt = it->second.find(pid);
-    if (pidIt != it->second.end()) {
+    {
+        std::lock_guard<std::mutex> clientLock(clientMutex_);
+        auto it = clientMap_.find(sensorId);
+        if (it == clientMap_.end()) {
+            SEN_HILOGW("sensorId not exist");
+            return;
+        }
+        auto pidIt = it->second.find(pid);
+        if (pidIt == it->second.end()) {
+            return;
+        }
         it->second.erase(pidIt);
     }
+    PublishDispatchTable();
+    ResizeChannelBuffer(static_cast<int32_t>(pid));
 }
 
 bool ClientInfo::UpdateSensorChannel(int32_t pid, const sptr<SensorBasicDataChannel> &channel)
@@ -269,19 +393,24 @@ bool ClientInfo::UpdateSensorChannel(int32_t pid, const sptr<SensorBasicDataChan
         SEN_HILOGE("pid or channel is invalid or channel cannot be null");
         return false;
     }
-    std::lock_guard<std::mutex> channelLock(channelMutex_);
-    auto it = channelMap_.find(pid);
-    if (it == channelMap_.end()) {
-        if (channelMap_.size() == MAX_SUPPORT_CHANNEL) {
-            SEN_HILOGE("max support channel size : %{public}u", MAX_SUPPORT_CHANNEL);
-            return false;
+    bool ret = true;
+    {
+        std::lock_guard<std::mutex> channelLock(channelMutex_);
+        auto it = channelMap_.find(pid);
+        if (it == channelMap_.end()) {
+            if (channelMap_.size() == MAX_SUPPORT_CHANNEL) {
+                SEN_HILOGE("max support channel size : %{public}u", MAX_SUPPORT_CHANNEL);
+                return false;
+            }
+            auto insertRet = channelMap_.insert(std::make_pair(pid, channel));
+            SEN_HILOGD("insertRet.second : %{public}d", insertRet.second);
+            ret = insertRet.second;
+        } else {
+            channelMap_[pid] = channel;
         }
-        auto ret = channelMap_.insert(std::make_pair(pid, channel));
-        SEN_HILOGD("ret.second : %{public}d", ret.second);
-        return ret.second;
     }
-    channelMap_[pid] = channel;
-    return true;
+    PublishDispatchTable();
+    return ret;
 }
 
 void ClientInfo::ClearSensorInfo(uint32_t sensorId)
@@ -291,13 +420,28 @@ void ClientInfo::ClearSensorInfo(uint32_t sensorId)
         SEN_HILOGE("sensorId is invalid");
         return;
     }
-    std::lock_guard<std::mutex> clientLock(clientMutex_);
-    auto it = clientMap_.find(sensorId);
-    if (it == clientMap_.end()) {
-        SEN_HILOGD("sensorId not exist, no need to clear it");
-        return;
+    std::vector<int32_t> pids;
+    {
+        std::lock_guard<std::mutex> clientLock(clientMutex_);
+        auto it = clientMap_.find(sensorId);
+        if (it == clientMap_.end()) {
+            SEN_HILOGD("sensorId not exist, no need to clear it");
+            return;
+        }
+        for (const auto &pidIt : it->second) {
+            pids.push_back(pidIt.first);
+        }
+        clientMap_.erase(it);
+        optionMap_.erase(sensorId);
+    }
+    for (int32_t pid : pids) {
+        ClearDeltaEncoding(sensorId, pid);
+    }
+    PublishDispatchTable();
+    // The remaining subscriptions of these clients need less room than before
+    for (int32_t pid : pids) {
+        ResizeChannelBuffer(pid);
     }
-    clientMap_.erase(it);
 }
 
 void ClientInfo::ClearCurPidSensorInfo(uint32_t sensorId, int32_t pid)
@@ -307,20 +451,38 @@ void ClientInfo::ClearCurPidSensorInfo(uint32_t sensorId, int32_t pid)
         SEN_HILOGE("sensorId or pid is invalid");
         return;
     }
-    std::lock_guard<std::mutex> clientLock(clientMutex_);
-    auto it = clientMap_.find(sensorId);
-    if (it == clientMap_.end()) {
-        SEN_HILOGD("sensorId not exist, no need to clear it");
-        return;
-    }
-    auto pidIt = it->second.find(pid);
-    if (pidIt == it->second.end()) {
-        SEN_HILOGD("pid not exist, no need to clear it");
-        return;
+    {
+        std::lock_guard<std::mutex> clientLock(clientMutex_);
+        auto it = clientMap_.find(sensorId);
+        if (it == clientMap_.end()) {
+            SEN_HILOGD("sensorId not exist, no need to clear it");
+            return;
+        }
+        auto pidIt = it->second.find(pid);
+        if (pidIt == it->second.end()) {
+            SEN_HILOGD("pid not exist, no need to clear it");
+            return;
+        }
+        pidIt = it->second.erase(pidIt);
+        if (it->second.size() == MIN_MAP_SIZE) {
+            it = clientMap_.erase(it);
+        }
+        auto optionIt = optionMap_.find(sensorId);
+        if (optionIt != optionMap_.end()) {
+            optionIt->second.erase(pid);
+        }
     }
-    pidIt = it->second.erase(pidIt);
-    if (it->second.size() == MIN_MAP_SIZE) {
-        it = clientMap_.erase(it);
+    ClearDeltaEncoding(sensorId, pid);
+    PublishDispatchTable();
+    ResizeChannelBuffer(pid);
+}
+
+void ClientInfo::ClearDeltaEncoding(uint32_t sensorId, int32_t pid)
+{
+    // The option goes with the subscription, a later one without it has to get lossless events again
+    auto channel = GetSensorChannelByPid(pid);
+    if (channel != nullptr) {
+        channel->SetDeltaQuantum(sensorId, 0.0f);
     }
 }
 
@@ -331,28 +493,41 @@ bool ClientInfo::DestroySensorChannel(int32_t pid)
         SEN_HILOGE("pid is invalid");
         return false;
     }
-    std::lock_guard<std::mutex> clientLock(clientMutex_);
-    for (auto it = clientMap_.begin(); it != clientMap_.end();) {
-        auto pidIt = it->second.find(pid);
-        if (pidIt == it->second.end()) {
-            it++;
-            continue;
+    {
+        std::lock_guard<std::mutex> clientLock(clientMutex_);
+        for (auto it = clientMap_.begin(); it != clientMap_.end();) {
+            auto pidIt = it->second.find(pid);
+            if (pidIt == it->second.end()) {
+                it++;
+                continue;
+            }
+            pidIt = it->second.erase(pidIt);
+            if (it->second.size() != MIN_MAP_SIZE) {
+                it++;
+                continue;
+            }
+            it = clientMap_.erase(it);
         }
-        pidIt = it->second.erase(pidIt);
-        if (it->second.size() != MIN_MAP_SIZE) {
-            it++;
-            continue;
+        for (auto &optionIt : optionMap_) {
+            optionIt.second.erase(pid);
+        }
+        {
+            std::lock_guard<std::mutex> uidLock(uidMutex_);
+            auto appThreadInfoIt = appThreadInfoMap_.find(pid);
+            if (appThreadInfoIt != appThreadInfoMap_.end()) {
+                PermissionUtil::GetInstance().ClearPermissionCache(appThreadInfoIt->second.callerToken);
+            }
+        }
+        DestroyAppThreadInfo(pid);
+        std::lock_guard<std::mutex> channelLock(channelMutex_);
+        auto it = channelMap_.find(pid);
+        if (it == channelMap_.end()) {
+            SEN_HILOGD("there is no channel belong to pid, no need to destroy");
+        } else {
+            it = channelMap_.erase(it);
         }
-        it = clientMap_.erase(it);
-    }
-    DestroyAppThreadInfo(pid);
-    std::lock_guard<std::mutex> channelLock(channelMutex_);
-    auto it = channelMap_.find(pid);
-    if (it == channelMap_.end()) {
-        SEN_HILOGD("there is no channel belong to pid, no need to destroy");
-        return true;
     }
-    it = channelMap_.erase(it);
+    PublishDispatchTable();
     return true;
 }
 
@@ -384,106 +559,102 @@ SensorBasicInfo ClientInfo::GetCurPidSensorInfo(uint32_t sensorId, int32_t pid)
     return sensorInfo;
 }
 
-uint64_t ClientInfo::ComputeBestPeriodCount(uint32_t sensorId, sptr<SensorBasicDataChannel> &channel)
+void ClientInfo::InitStoredEvents(const std::vector<Sensor> &sensors)
 {
-    if (sensorId == INVALID_SENSOR_ID || channel == nullptr) {
-        SEN_HILOGE("sensorId is invalid or channel cannot be null");
-        return 0UL;
+    CALL_LOG_ENTER;
+    auto table = std::make_shared<StoredEventTable>();
+    table->slots.reset(new (std::nothrow) StoredEventSlot[sensors.size()]);
+    if (table->slots == nullptr) {
+        SEN_HILOGE("alloc stored event slots failed");
+        return;
     }
-    int32_t pid = INVALID_PID;
-    {
-        std::lock_guard<std::mutex> channelLock(channelMutex_);
-        for (const auto &channelIt : channelMap_) {
-            if (channelIt.second == channel) {
-                pid = channelIt.first;
-            }
-        }
+    for (size_t i = 0; i < sensors.size(); i++) {
+        table->index[sensors[i].GetSensorId()] = static_cast<uint32_t>(i);
     }
+    std::atomic_store(&storedEvents_, std::shared_ptr<const StoredEventTable>(std::move(table)));
+}
 
-    int64_t bestSamplingPeriod = GetBestSensorInfo(sensorId).GetSamplingPeriodNs();
-    int64_t curSamplingPeriod = GetCurPidSensorInfo(sensorId, pid).GetSamplingPeriodNs();
-    if (bestSamplingPeriod == 0L) {
-        SEN_HILOGE("best Sensor Sampling Period is 0");
-        return 0UL;
+ClientInfo::StoredEventSlot *ClientInfo::FindStoredEventSlot(uint32_t sensorId,
+    std::shared_ptr<const StoredEventTable> &table)
+{
+    // The caller keeps table alive for as long as it uses the returned slot
+    table = std::atomic_load(&storedEvents_);
+    if (table == nullptr || table->slots == nullptr) {
+        return nullptr;
+    }
+    auto indexIt = table->index.find(sensorId);
+    if (indexIt == table->index.end()) {
+        return nullptr;
     }
-    int64_t ret = curSamplingPeriod / bestSamplingPeriod;
-    return (ret <= 0L) ? 0UL : ret;
+    return &table->slots[indexIt->second];
 }
 
-uint64_t ClientInfo::ComputeBestFifoCount(uint32_t sensorId, sptr<SensorBasicDataChannel> &channel)
+uint32_t ClientInfo::BeginStoredEventWrite(StoredEventSlot &slot)
 {
-    if (channel == nullptr || sensorId == INVALID_SENSOR_ID) {
-        SEN_HILOGE("sensorId is invalid or channel cannot be null");
-        return 0UL;
-    }
-    int32_t pid = INVALID_PID;
-    {
-        std::lock_guard<std::mutex> channelLock(channelMutex_);
-        for (const auto &channelIt : channelMap_) {
-            if (channelIt.second == channel) {
-                pid = channelIt.first;
+    // An odd sequence marks a write in progress, it also serializes concurrent writers
+    uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    do {
+        while ((sequence & 1U) != 0) {
+            sequence = slot.sequence.load(std::memory_order_relaxed);
+        }
+    } while (!slot.sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire,
+                                                  std::memory_order_relaxed));
+    std::atomic_thread_fence(std::memory_order_release);
+    return sequence;
+}
+
+void ClientInfo::WriteStoredEvent(StoredEventSlot &slot, const struct TransferSensorEvents *event)
+{
+    uint32_t sequence = BeginStoredEventWrite(slot);
+    slot.hasEvent = (event != nullptr);
+    if (event != nullptr) {
+        slot.event = *event;
+        // Heart rate data is never kept for dump
+        if (event->sensorTypeId != HEART_RATE_SENSOR_ID) {
+            slot.history[(slot.historyHead + slot.historyCount) % MAX_DUMP_DATA_SIZE] = *event;
+            if (slot.historyCount < MAX_DUMP_DATA_SIZE) {
+                slot.historyCount++;
+            } else {
+                slot.historyHead = (slot.historyHead + 1) % MAX_DUMP_DATA_SIZE;
             }
         }
     }
-    int64_t curReportDelay = GetCurPidSensorInfo(sensorId, pid).GetMaxReportDelayNs();
-    int64_t curSamplingPeriod = GetCurPidSensorInfo(sensorId, pid).GetSamplingPeriodNs();
-    if (curSamplingPeriod == 0L) {
-        SEN_HILOGE("best sensor fifo count is 0");
-        return 0UL;
-    }
-    int64_t ret = curReportDelay / curSamplingPeriod;
-    return (ret <= 0L) ? 0UL : ret;
+    slot.sequence.store(sequence + 2, std::memory_order_release);
 }
 
-int32_t ClientInfo::GetStoreEvent(int32_t sensorId, struct SensorEvent &event)
+int32_t ClientInfo::GetStoreEvent(int32_t sensorId, struct TransferSensorEvents &event)
 {
-    std::lock_guard<std::mutex> lock(eventMutex_);
-    auto storedEvent = storedEvent_.find(sensorId);
-    if (storedEvent != storedEvent_.end()) {
-        errno_t ret = memcpy_s(&event, sizeof(struct SensorEvent), &storedEvent->second, sizeof(struct SensorEvent));
-        if (ret != EOK) {
-            SEN_HILOGE("memcpy_s failed, sensorId : %{public}d", sensorId);
-            return ret;
+    std::shared_ptr<const StoredEventTable> table;
+    StoredEventSlot *slot = FindStoredEventSlot(static_cast<uint32_t>(sensorId), table);
+    if (slot != nullptr) {
+        bool hasEvent = false;
+        uint32_t sequence = 0;
+        do {
+            sequence = slot->sequence.load(std::memory_order_acquire);
+            if ((sequence & 1U) != 0) {
+                continue;
+            }
+            hasEvent = slot->hasEvent;
+            event = slot->event;
+            std::atomic_thread_fence(std::memory_order_acquire);
+        } while (((sequence & 1U) != 0) || (slot->sequence.load(std::memory_order_relaxed) != sequence));
+        if (hasEvent) {
+            return ERR_OK;
         }
-        return ERR_OK;
     }
-
     SEN_HILOGE("can't get store event, sensorId : %{public}u", sensorId);
     return NO_STROE_EVENT;
 }
 
-void ClientInfo::StoreEvent(const struct SensorEvent &event)
+void ClientInfo::StoreEvent(const struct TransferSensorEvents &event)
 {
-    bool foundSensor = false;
-    struct SensorEvent storedEvent;
-    auto sensorHdiConnection = &SensorHdiConnection::GetInstance();
-    if (sensorHdiConnection == nullptr) {
-        SEN_HILOGE("sensorHdiConnection cannot be null");
+    std::shared_ptr<const StoredEventTable> table;
+    StoredEventSlot *slot = FindStoredEventSlot(event.sensorTypeId, table);
+    if (slot == nullptr) {
+        SEN_HILOGD("sensorId is not supported, sensorId : %{public}u", event.sensorTypeId);
         return;
     }
-    std::vector<Sensor> sensors;
-    int32_t ret = sensorHdiConnection->GetSensorList(sensors);
-    if (ret < 0) {
-        SEN_HILOGE("GetSensorList is failed");
-        return;
-    }
-    errno_t retVal = memcpy_s(&storedEvent, sizeof(storedEvent), &event, sizeof(event));
-    if (retVal != EOK) {
-        SEN_HILOGE("memcpy_s is failed");
-        return;
-    }
-    for (size_t i = 0; i < sensors.size(); i++) {
-        if ((int32_t)(sensors[i].GetSensorId()) == storedEvent.sensorTypeId) {
-            SEN_HILOGD("sensorFlags : %{public}u", sensors[i].GetFlags());
-            foundSensor = true;
-            break;
-        }
-    }
-
-    if (foundSensor) {
-        std::lock_guard<std::mutex> lock(eventMutex_);
-        storedEvent_[storedEvent.sensorTypeId] = storedEvent;
-    }
+    WriteStoredEvent(*slot, &event);
 }
 
 bool ClientInfo::SaveClientPid(const sptr<IRemoteObject> &sensorClient, int32_t pid)
@@ -528,8 +699,14 @@ void ClientInfo::DestroyClientPid(const sptr<IRemoteObject> &sensorClient)
 
 void ClientInfo::ClearEvent()
 {
-    std::lock_guard<std::mutex> lock(eventMutex_);
-    storedEvent_.clear();
+    auto table = std::atomic_load(&storedEvents_);
+    if (table == nullptr || table->slots == nullptr) {
+        SEN_HILOGD("stored event slots are not initialized");
+        return;
+    }
+    for (const auto &indexIt : table->index) {
+        WriteStoredEvent(table->slots[indexIt.second], nullptr);
+    }
 }
 
 std::vector<uint32_t> ClientInfo::GetSensorIdByPid(int32_t pid)
@@ -546,29 +723,6 @@ std::vector<uint32_t> ClientInfo::GetSensorIdByPid(int32_t pid)
     return sensorIdVec;
 }
 
-AppThreadInfo ClientInfo::GetAppInfoByChannel(const sptr<SensorBasicDataChannel> &channel)
-{
-    CALL_LOG_ENTER;
-    AppThreadInfo appThreadInfo;
-    {
-        std::lock_guard<std::mutex> channelLock(channelMutex_);
-        for (auto channelIt = channelMap_.begin(); channelIt != channelMap_.end(); channelIt++) {
-            if (channelIt->second == channel) {
-                appThreadInfo.pid = channelIt->first;
-            }
-        }
-    }
-    {
-        std::lock_guard<std::mutex> uidLock(uidMutex_);
-        auto it = appThreadInfoMap_.find(appThreadInfo.pid);
-        if (it != appThreadInfoMap_.end()) {
-            appThreadInfo.uid = it->second.uid;
-            appThreadInfo.callerToken = it->second.callerToken;
-        }
-    }
-    return appThreadInfo;
-}
-
 void ClientInfo::GetSensorChannelInfo(std::vector<SensorChannelInfo> &channelInfo)
 {
     CALL_LOG_ENTER;
@@ -649,38 +803,103 @@ std::vector<int32_t> ClientInfo::GetCmdList(uint32_t sensorId, int32_t uid)
     return uidIt->second;
 }
 
-void ClientInfo::UpdateDataQueue(int32_t sensorId, struct SensorEvent &event)
+void ClientInfo::UpdateSensorOption(uint32_t sensorId, int32_t pid, int32_t option)
 {
     CALL_LOG_ENTER;
-    if (sensorId == HEART_RATE_SENSOR_ID) {
+    if ((sensorId == INVALID_SENSOR_ID) || (pid <= INVALID_PID)) {
+        SEN_HILOGE("sensorId or pid is invalid");
         return;
     }
-    std::lock_guard<std::mutex> queueLock(dataQueueMutex_);
-    auto it = dumpQueue_.find(sensorId);
-    if (it == dumpQueue_.end()) {
-        std::queue<struct SensorEvent> q;
-        q.push(event);
-        dumpQueue_.insert(std::make_pair(sensorId, q));
-        return;
+    {
+        std::lock_guard<std::mutex> clientLock(clientMutex_);
+        optionMap_[sensorId][pid] = option;
+    }
+    PublishDispatchTable();
+}
+
+void ClientInfo::ResizeChannelBuffer(int32_t pid)
+{
+    size_t eventCount = 0;
+    {
+        std::lock_guard<std::mutex> clientLock(clientMutex_);
+        for (const auto &clientIt : clientMap_) {
+            auto pidIt = clientIt.second.find(pid);
+            if (pidIt == clientIt.second.end()) {
+                continue;
+            }
+            int64_t samplingPeriodNs = pidIt->second.GetSamplingPeriodNs();
+            if (samplingPeriodNs <= 0) {
+                continue;
+            }
+            // One whole FIFO batch plus whatever keeps arriving while the client is getting to it
+            int64_t batchCount = pidIt->second.GetMaxReportDelayNs() / samplingPeriodNs;
+            int64_t drainCount = std::max(CHANNEL_DRAIN_WINDOW_NS / samplingPeriodNs, static_cast<int64_t>(1));
+            eventCount += static_cast<size_t>(std::max(batchCount, static_cast<int64_t>(0)) + drainCount);
+        }
     }
-    it->second.push(event);
-    if (it->second.size() > MAX_DUMP_DATA_SIZE) {
-        it->second.pop();
+    auto channel = GetSensorChannelByPid(pid);
+    CHKPV(channel);
+    if (channel->SetSendBufferSize(eventCount) != ERR_OK) {
+        SEN_HILOGW("resize channel buffer failed, pid : %{public}d", pid);
     }
 }
 
-std::unordered_map<uint32_t, std::queue<struct SensorEvent>> ClientInfo::GetDumpQueue()
+std::unordered_map<uint32_t, std::queue<struct TransferSensorEvents>> ClientInfo::GetDumpQueue()
 {
-    return dumpQueue_;
+    std::unordered_map<uint32_t, std::queue<struct TransferSensorEvents>> dumpQueue;
+    auto table = std::atomic_load(&storedEvents_);
+    if (table == nullptr || table->slots == nullptr) {
+        return dumpQueue;
+    }
+    std::vector<struct TransferSensorEvents> history(MAX_DUMP_DATA_SIZE);
+    for (const auto &indexIt : table->index) {
+        const StoredEventSlot &slot = table->slots[indexIt.second];
+        uint32_t historyHead = 0;
+        uint32_t historyCount = 0;
+        uint32_t sequence = 0;
+        do {
+            sequence = slot.sequence.load(std::memory_order_acquire);
+            if ((sequence & 1U) != 0) {
+                continue;
+            }
+            historyHead = slot.historyHead;
+            historyCount = std::min(slot.historyCount, MAX_DUMP_DATA_SIZE);
+            std::copy(slot.history, slot.history + MAX_DUMP_DATA_SIZE, history.begin());
+            std::atomic_thread_fence(std::memory_order_acquire);
+        } while (((sequence & 1U) != 0) || (slot.sequence.load(std::memory_order_relaxed) != sequence));
+        if (historyCount == 0) {
+            continue;
+        }
+        auto &queue = dumpQueue[indexIt.first];
+        for (uint32_t i = 0; i < historyCount; i++) {
+            queue.push(history[(historyHead + i) % MAX_DUMP_DATA_SIZE]);
+        }
+    }
+    return dumpQueue;
 }
 
 void ClientInfo::ClearDataQueue(int32_t sensorId)
 {
-    std::lock_guard<std::mutex> queueLock(dataQueueMutex_);
-    auto it = dumpQueue_.find(sensorId);
-    if (it != dumpQueue_.end()) {
-        dumpQueue_.erase(it);
+    std::shared_ptr<const StoredEventTable> table;
+    StoredEventSlot *slot = FindStoredEventSlot(static_cast<uint32_t>(sensorId), table);
+    if (slot == nullptr) {
+        return;
+    }
+    uint32_t sequence = BeginStoredEventWrite(*slot);
+    slot->historyHead = 0;
+    slot->historyCount = 0;
+    slot->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void ClientInfo::OnPermissionChanged(AccessTokenID callerToken, int32_t sensorTypeId, bool granted)
+{
+    if (granted) {
+        SEN_HILOGI("permission granted, callerToken : %{public}u, sensorId : %{public}d", callerToken, sensorTypeId);
+    } else {
+        SEN_HILOGE("permission revoked, stop delivery, callerToken : %{public}u, sensorId : %{public}d",
+            callerToken, sensorTypeId);
     }
+    PublishDispatchTable();
 }
 }  // namespace Sensors
 }  // namespace OHOS
@@ -15,9 +15,16 @@
 
 #include "fifo_cache_data.h"
 
+#include "sensor_decimation.h"
+
 namespace OHOS {
 namespace Sensors {
-FifoCacheData::FifoCacheData() : periodCount_(0), channel_(nullptr)
+namespace {
+constexpr size_t MAX_FIFO_CACHE_COUNT = 1000;
+}  // namespace
+
+FifoCacheData::FifoCacheData()
+    : nextDueTimestamp_(0), grantExpiry_(0), channel_(nullptr), fifoCapacity_(0), fifoSize_(0)
 {}
 
 FifoCacheData::~FifoCacheData()
@@ -27,28 +34,63 @@ FifoCacheData::~FifoCacheData()
 
 void FifoCacheData::InitFifoCache()
 {
-    periodCount_ = 0;
-    fifoCacheData_.clear();
+    fifoSize_ = 0;
+}
+
+int64_t &FifoCacheData::GetGrantExpiry()
+{
+    return grantExpiry_;
+}
+
+bool FifoCacheData::IsSampleDue(int64_t timestamp, int64_t samplingPeriodNs, int64_t toleranceNs)
+{
+    return SensorDecimation::IsSampleDue(nextDueTimestamp_, timestamp, samplingPeriodNs, toleranceNs);
+}
+
+const struct TransferSensorEvents *FifoCacheData::FilterSample(const struct TransferSensorEvents &event,
+    int64_t inputPeriodNs, int64_t outputPeriodNs)
+{
+    if (filter_ == nullptr) {
+        filter_.reset(new (std::nothrow) SensorLowPassFilter());
+        if (filter_ == nullptr) {
+            return &event;
+        }
+    }
+    filter_->Configure(inputPeriodNs, outputPeriodNs);
+    filter_->Update(event);
+    return &filter_->GetOutput();
 }
 
-void FifoCacheData::SetPeriodCount(uint64_t periodCount)
+void FifoCacheData::ReserveFifoCache(uint64_t fifoCount)
 {
-    periodCount_ = periodCount;
+    size_t capacity = (fifoCount < MAX_FIFO_CACHE_COUNT) ? static_cast<size_t>(fifoCount) : MAX_FIFO_CACHE_COUNT;
+    if (capacity == fifoCapacity_) {
+        return;
+    }
+    // The storage only grows, a smaller batch size just flushes earlier and keeps the cached events
+    if (capacity > fifoCacheData_.size()) {
+        fifoCacheData_.resize(capacity);
+    }
+    fifoCapacity_ = capacity;
 }
 
-uint64_t FifoCacheData::GetPeriodCount() const
+bool FifoCacheData::AppendFifoCacheData(const struct TransferSensorEvents &event)
 {
-    return periodCount_;
+    if (fifoSize_ >= fifoCacheData_.size()) {
+        return true;
+    }
+    fifoCacheData_[fifoSize_++] = event;
+    return fifoSize_ >= fifoCapacity_;
 }
 
-void FifoCacheData::SetFifoCacheData(const std::vector<struct SensorEvent> &fifoCacheData)
+const struct TransferSensorEvents *FifoCacheData::GetFifoCacheBuffer() const
 {
-    fifoCacheData_ = fifoCacheData;
+    return fifoCacheData_.data();
 }
 
-std::vector<struct SensorEvent> FifoCacheData::GetFifoCacheData() const
+size_t FifoCacheData::GetFifoCacheSize() const
 {
-    return fifoCacheData_;
+    return fifoSize_;
 }
 
 void FifoCacheData::SetChannel(const sptr<SensorBasicDataChannel> &channel)
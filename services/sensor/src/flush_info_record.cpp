@@ -32,19 +32,23 @@ enum {
 };
 }  // namespace
 
-std::unordered_map<uint32_t, std::vector<struct FlushInfo>> FlushInfoRecord::GetFlushInfo()
+std::shared_ptr<const FlushInfoMap> FlushInfoRecord::GetFlushInfo() const
 {
-    CALL_LOG_ENTER;
-    std::lock_guard<std::mutex> flushLock(flushInfoMutex_);
-    return flushInfo_;
+    return std::atomic_load(&flushInfoSnapshot_);
+}
+
+void FlushInfoRecord::PublishFlushInfo()
+{
+    std::atomic_store(&flushInfoSnapshot_, std::make_shared<const FlushInfoMap>(flushInfo_));
 }
 
 void FlushInfoRecord::ClearFlushInfoItem(uint32_t sensorId)
 {
     std::lock_guard<std::mutex> flushLock(flushInfoMutex_);
     auto it = flushInfo_.find(sensorId);
-    if (it != flushInfo_.end()) {
+    if (it != flushInfo_.end() && !it->second.empty()) {
         it->second.erase(it->second.begin());
+        PublishFlushInfo();
     }
 }
 
@@ -63,20 +67,22 @@ ErrCode FlushInfoRecord::SetFlushInfo(uint32_t sensorId, const sptr<SensorBasicD
         std::vector<struct FlushInfo> vec { flush };
         flushInfo_.insert(std::make_pair(sensorId, vec));
     }
+    PublishFlushInfo();
     return ERR_OK;
 }
 
-bool FlushInfoRecord::IsFlushChannelValid(const std::vector<sptr<SensorBasicDataChannel>> &currChannelList,
-                                          const sptr<SensorBasicDataChannel> &flushChannel)
+const SubscriberRecord *FlushInfoRecord::FindFlushSubscriber(const std::vector<SubscriberRecord> &subscribers,
+                                                             const sptr<SensorBasicDataChannel> &flushChannel)
 {
-    SEN_HILOGD("channel list size : %{public}u", static_cast<uint32_t>(currChannelList.size()));
-    for (const auto &channel : currChannelList) {
-        SEN_HILOGD("channel : %{public}p, flushchannel : %{public}p", channel.GetRefPtr(), flushChannel.GetRefPtr());
-        if (channel == flushChannel) {
-            return true;
+    SEN_HILOGD("subscriber size : %{public}u", static_cast<uint32_t>(subscribers.size()));
+    for (const auto &subscriber : subscribers) {
+        SEN_HILOGD("channel : %{public}p, flushchannel : %{public}p", subscriber.channel.GetRefPtr(),
+                   flushChannel.GetRefPtr());
+        if (subscriber.channel == flushChannel) {
+            return &subscriber;
         }
     }
-    return false;
+    return nullptr;
 }
 
 int32_t FlushInfoRecord::GetFlushChannelIndex(const std::vector<struct FlushInfo> &flushInfoList,
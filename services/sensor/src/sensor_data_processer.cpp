@@ -15,7 +15,10 @@
 
 #include "sensor_data_processer.h"
 
+#include <sched.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
+#include <unistd.h>
 #include <thread>
 
 #include "permission_util.h"
@@ -45,338 +48,393 @@ constexpr uint32_t SENSOR_CATAGORY_SHIFT = 24;
 constexpr uint32_t FLUSH_COMPLETE_ID = ((uint32_t)OTHER << SENSOR_CATAGORY_SHIFT) |
                                        ((uint32_t)SENSOR_TYPE_FLUSH << SENSOR_TYPE_SHIFT) |
                                        ((uint32_t)FIRST_INDEX << SENSOR_INDEX_SHIFT);
+constexpr int32_t MAX_BACKLOG_EPOLL_EVENTS = 16;
+// A degraded client gets a quarter of its requested rate until it keeps up again
+constexpr int64_t DEGRADED_RATE_DIVISOR = 4;
+constexpr int32_t BACKLOG_SWEEP_INTERVAL_MS = 1000;
 }  // namespace
 
 SensorDataProcesser::SensorDataProcesser(const std::unordered_map<uint32_t, Sensor> &sensorMap)
 {
     sensorMap_.insert(sensorMap.begin(), sensorMap.end());
     SEN_HILOGD("sensorMap_.size : %{public}d", int32_t { sensorMap_.size() });
+    backlogEpollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (backlogEpollFd_ < 0) {
+        SEN_HILOGE("create backlog epoll failed, errno : %{public}d", errno);
+    }
 }
 
 SensorDataProcesser::~SensorDataProcesser()
 {
-    dataCountMap_.clear();
     sensorMap_.clear();
+    if (backlogEpollFd_ >= 0) {
+        close(backlogEpollFd_);
+        backlogEpollFd_ = -1;
+    }
 }
 
-void SensorDataProcesser::SendNoneFifoCacheData(std::unordered_map<uint32_t, struct SensorEvent> &cacheBuf,
-                                                sptr<SensorBasicDataChannel> &channel, struct SensorEvent &event,
-                                                uint64_t periodCount)
+const struct TransferSensorEvents *SensorDataProcesser::DecimateEvent(const SubscriberRecord &subscriber,
+    const struct TransferSensorEvents &event)
 {
-    std::vector<struct SensorEvent> sendEvents;
-    std::lock_guard<std::mutex> dataCountLock(dataCountMutex_);
-    sendEvents.push_back(event);
-    uint32_t sensorId = static_cast<uint32_t>(event.sensorTypeId);
-    if (sensorId == FLUSH_COMPLETE_ID) {
-        sensorId = static_cast<uint32_t>(event.sensorTypeId);
-    }
-    auto dataCountIt = dataCountMap_.find(sensorId);
-    if (dataCountIt == dataCountMap_.end()) {
-        std::vector<sptr<FifoCacheData>> channelFifoList;
-        sptr<FifoCacheData> fifoCacheData = new (std::nothrow) FifoCacheData();
-        CHKPV(fifoCacheData);
-        fifoCacheData->SetChannel(channel);
-        channelFifoList.push_back(fifoCacheData);
-        dataCountMap_.insert(std::make_pair(sensorId, channelFifoList));
-        SendRawData(cacheBuf, channel, sendEvents);
-        return;
+    const auto &dispatchState = subscriber.dispatchState;
+    CHKPP(dispatchState);
+    int64_t samplingPeriodNs = subscriber.samplingPeriodNs;
+    if (subscriber.channel->GetConsumerState() == CONSUMER_DEGRADED) {
+        samplingPeriodNs *= DEGRADED_RATE_DIVISOR;
     }
-    bool channelExist = false;
-    for (const auto &fifoCacheData : dataCountIt->second) {
-        if (fifoCacheData->GetChannel() != channel) {
-            continue;
-        }
-        channelExist = true;
-        uint64_t curCount = fifoCacheData->GetPeriodCount();
-        curCount++;
-        fifoCacheData->SetPeriodCount(curCount);
-        if (periodCount != 0 && fifoCacheData->GetPeriodCount() % periodCount != 0UL) {
-            continue;
-        }
-        SendRawData(cacheBuf, channel, sendEvents);
-        fifoCacheData->SetPeriodCount(0);
-        return;
+    const struct TransferSensorEvents *output = &event;
+    if (subscriber.antiAliasFilter) {
+        // The filter has to see every hardware sample, also the ones this subscriber will not get
+        output = dispatchState->FilterSample(event, subscriber.inputPeriodNs, samplingPeriodNs);
     }
-    if (!channelExist) {
-        sptr<FifoCacheData> fifoCacheData = new (std::nothrow) FifoCacheData();
-        CHKPV(fifoCacheData);
-        fifoCacheData->SetChannel(channel);
-        dataCountIt->second.push_back(fifoCacheData);
-        SendRawData(cacheBuf, channel, sendEvents);
+    // Half a hardware period of timestamp jitter is accepted when matching the schedule
+    if (!dispatchState->IsSampleDue(event.timestamp, samplingPeriodNs, subscriber.inputPeriodNs / 2)) {
+        return nullptr;
     }
+    return output;
 }
 
-void SensorDataProcesser::SendFifoCacheData(std::unordered_map<uint32_t, struct SensorEvent> &cacheBuf,
-                                            sptr<SensorBasicDataChannel> &channel, struct SensorEvent &event,
-                                            uint64_t periodCount, uint64_t fifoCount)
+void SensorDataProcesser::SendNoneFifoCacheData(const SubscriberRecord &subscriber,
+                                                struct TransferSensorEvents &event, DispatchOutbox &outbox)
 {
-    uint32_t sensorId = static_cast<uint32_t>(event.sensorTypeId);
-    if (sensorId == FLUSH_COMPLETE_ID) {
-        sensorId = static_cast<uint32_t>(event.sensorTypeId);
-    }
-    std::lock_guard<std::mutex> dataCountLock(dataCountMutex_);
-    auto dataCountIt = dataCountMap_.find(sensorId);
-    // there is no channelFifoList
-    if (dataCountIt == dataCountMap_.end()) {
-        std::vector<sptr<FifoCacheData>> channelFifoList;
-        sptr<FifoCacheData> fifoCacheData = new (std::nothrow) FifoCacheData();
-        CHKPV(fifoCacheData);
-        fifoCacheData->SetChannel(channel);
-        channelFifoList.push_back(fifoCacheData);
-        dataCountMap_.insert(std::make_pair(sensorId, channelFifoList));
+    const struct TransferSensorEvents *output = DecimateEvent(subscriber, event);
+    if (output == nullptr) {
         return;
     }
-    // find channel in channelFifoList
-    bool channelExist = false;
-    for (auto &fifoData : dataCountIt->second) {
-        if (fifoData->GetChannel() != channel) {
-            continue;
-        }
-        channelExist = true;
-        uint64_t curCount = fifoData->GetPeriodCount();
-        curCount++;
-        fifoData->SetPeriodCount(curCount);
-        if (fifoData->GetPeriodCount() % periodCount != 0UL) {
-            continue;
-        }
-        fifoData->SetPeriodCount(0);
-        std::vector<struct SensorEvent> fifoDataList = fifoData->GetFifoCacheData();
-        fifoDataList.push_back(event);
-        fifoData->SetFifoCacheData(fifoDataList);
-        if ((fifoData->GetFifoCacheData()).size() != fifoCount) {
-            continue;
-        }
-        SendRawData(cacheBuf, channel, fifoData->GetFifoCacheData());
-        fifoData->InitFifoCache();
+    SendRawData(subscriber, output, 1, outbox);
+}
+
+void SensorDataProcesser::SendFifoCacheData(const SubscriberRecord &subscriber, struct TransferSensorEvents &event,
+                                            DispatchOutbox &outbox)
+{
+    const struct TransferSensorEvents *output = DecimateEvent(subscriber, event);
+    if (output == nullptr) {
         return;
     }
-    // cannot find channel in channelFifoList
-    if (!channelExist) {
-        sptr<FifoCacheData> fifoCacheData = new (std::nothrow) FifoCacheData();
-        CHKPV(fifoCacheData);
-        fifoCacheData->SetChannel(channel);
-        dataCountIt->second.push_back(fifoCacheData);
+    const auto &fifoData = subscriber.dispatchState;
+    // No-op unless the subscription changed, the batch buffer is allocated once per subscriber
+    fifoData->ReserveFifoCache(subscriber.fifoCount);
+    if (!fifoData->AppendFifoCacheData(*output)) {
+        return;
     }
+    SendRawData(subscriber, fifoData->GetFifoCacheBuffer(), fifoData->GetFifoCacheSize(), outbox);
+    fifoData->InitFifoCache();
 }
 
-void SensorDataProcesser::ReportData(sptr<SensorBasicDataChannel> &channel, struct SensorEvent &event)
+void SensorDataProcesser::ReportData(const SubscriberRecord &subscriber, struct TransferSensorEvents &event,
+                                     DispatchOutbox &outbox)
 {
-    CHKPV(channel);
-    uint32_t sensorId = static_cast<uint32_t>(event.sensorTypeId);
-    if (sensorId == FLUSH_COMPLETE_ID) {
-        sensorId = static_cast<uint32_t>(event.sensorTypeId);
-    }
-    auto &cacheBuf = const_cast<std::unordered_map<uint32_t, struct SensorEvent> &>(channel->GetDataCacheBuf());
-    if (ReportNotContinuousData(cacheBuf, channel, event)) {
+    CHKPV(subscriber.channel);
+    if (ReportNotContinuousData(subscriber, event, outbox)) {
         return;
     }
-    uint64_t periodCount = clientInfo_.ComputeBestPeriodCount(sensorId, channel);
-    if (periodCount == 0UL) {
+    if (subscriber.periodCount == 0UL) {
         return;
     }
-    auto fifoCount = clientInfo_.ComputeBestFifoCount(sensorId, channel);
-    if (fifoCount <= 0) {
-        SendNoneFifoCacheData(cacheBuf, channel, event, periodCount);
+    if (subscriber.fifoCount == 0UL) {
+        SendNoneFifoCacheData(subscriber, event, outbox);
         return;
     }
-    SendFifoCacheData(cacheBuf, channel, event, periodCount, fifoCount);
+    SendFifoCacheData(subscriber, event, outbox);
 }
 
-bool SensorDataProcesser::ReportNotContinuousData(std::unordered_map<uint32_t, struct SensorEvent> &cacheBuf,
-                                                  sptr<SensorBasicDataChannel> &channel, struct SensorEvent &event)
+bool SensorDataProcesser::ReportNotContinuousData(const SubscriberRecord &subscriber,
+                                                  struct TransferSensorEvents &event, DispatchOutbox &outbox)
 {
     uint32_t sensorId = static_cast<uint32_t>(event.sensorTypeId);
     if (sensorId == FLUSH_COMPLETE_ID) {
         sensorId = static_cast<uint32_t>(event.sensorTypeId);
     }
-    std::lock_guard<std::mutex> sensorLock(sensorMutex_);
-    auto sensor = sensorMap_.find(sensorId);
-    sensor->second.SetFlags(event.mode);
-    if (sensor == sensorMap_.end()) {
+    // sensorMap_ is never written after construction, every worker may look it up without locking
+    if (sensorMap_.find(sensorId) == sensorMap_.end()) {
         SEN_HILOGE("data's sensorId is not supported");
         return false;
     }
-    if (((SENSOR_ON_CHANGE & sensor->second.GetFlags()) == SENSOR_ON_CHANGE) ||
-        ((SENSOR_ONE_SHOT & sensor->second.GetFlags()) == SENSOR_ONE_SHOT)) {
-        std::vector<struct SensorEvent> sendEvents;
-        sendEvents.push_back(event);
-        SendRawData(cacheBuf, channel, sendEvents);
+    // The reporting mode comes with every event, it is not copied into the shared Sensor description
+    uint32_t mode = static_cast<uint32_t>(event.mode);
+    if (((SENSOR_ON_CHANGE & mode) == SENSOR_ON_CHANGE) || ((SENSOR_ONE_SHOT & mode) == SENSOR_ONE_SHOT)) {
+        SendRawData(subscriber, &event, 1, outbox);
         return true;
     }
     return false;
 }
 
-bool SensorDataProcesser::CheckSendDataPermission(sptr<SensorBasicDataChannel> channel, uint32_t sensorId)
+void SensorDataProcesser::SendRawData(const SubscriberRecord &subscriber, const struct TransferSensorEvents *events,
+                                      size_t eventNum, DispatchOutbox &outbox)
 {
-    AppThreadInfo appThreadInfo = clientInfo_.GetAppInfoByChannel(channel);
-    PermissionUtil &permissionUtil = PermissionUtil::GetInstance();
-    return permissionUtil.CheckSensorPermission(appThreadInfo.callerToken, sensorId);
+    const auto &channel = subscriber.channel;
+    CHKPV(channel);
+    if (events == nullptr || eventNum == 0) {
+        return;
+    }
+    // Events are only queued here, FlushOutbox sends everything a channel got in this drain at once
+    // A drain only reaches a handful of channels, a linear scan beats hashing and needs no per-drain rebuild
+    size_t entryIndex = 0;
+    while (entryIndex < outbox.count && outbox.entries[entryIndex].channel != channel) {
+        entryIndex++;
+    }
+    if (entryIndex == outbox.count) {
+        if (outbox.count == outbox.entries.size()) {
+            outbox.entries.emplace_back();
+        }
+        outbox.entries[outbox.count].channel = channel;
+        outbox.count++;
+    }
+    auto &outboxEvents = outbox.entries[entryIndex].events;
+    outboxEvents.insert(outboxEvents.end(), events, events + eventNum);
 }
 
-void SensorDataProcesser::SendRawData(std::unordered_map<uint32_t, struct SensorEvent> &cacheBuf,
-                                      sptr<SensorBasicDataChannel> channel, std::vector<struct SensorEvent> event)
+void SensorDataProcesser::FlushOutbox(DispatchOutbox &outbox)
 {
-    CHKPV(channel);
-    if (event.empty()) {
+    for (size_t i = 0; i < outbox.count; i++) {
+        auto &entry = outbox.entries[i];
+        const auto &channel = entry.channel;
+        // A lagging client is only written to from BacklogThread once its socket is writable, not on every drain
+        bool isLagging = (channel->GetConsumerState() != CONSUMER_NORMAL);
+        if (channel->HasBacklog() && (isLagging || channel->FlushBacklog() != ERR_OK)) {
+            // The socket is still full, queue behind the backlog so the client sees events in order
+            channel->EnqueueBacklog(entry.events.data(), entry.events.size());
+        } else {
+            size_t sentNum = 0;
+            auto ret = channel->SendEventBatch(entry.events.data(), entry.events.size(), sentNum);
+            if (ret != ERR_OK) {
+                SEN_HILOGD("socket full, ret : %{public}d, sent : %{public}zu of %{public}zu",
+                    ret, sentNum, entry.events.size());
+                channel->EnqueueBacklog(entry.events.data() + sentNum, entry.events.size() - sentNum);
+            }
+        }
+        channel->UpdateConsumerState();
+        if (channel->HasBacklog()) {
+            WatchBacklog(channel);
+        }
+        // Keep the buffer capacity for the next drain but do not hold the channel alive
+        entry.events.clear();
+        entry.channel = nullptr;
+    }
+    outbox.count = 0;
+}
+
+void SensorDataProcesser::WatchBacklog(const sptr<SensorBasicDataChannel> &channel)
+{
+    int32_t sendFd = channel->GetSendDataFd();
+    if (backlogEpollFd_ < 0 || sendFd < 0) {
         return;
     }
-    if (!CheckSendDataPermission(channel, event[0].sensorTypeId)) {
-        SEN_HILOGE("permission denied");
+    std::lock_guard<std::mutex> backlogLock(backlogMutex_);
+    auto watchIt = backlogChannels_.find(sendFd);
+    if (watchIt != backlogChannels_.end() && watchIt->second.promote() == channel) {
         return;
     }
+    // A stale entry means the fd number was reused after its channel was destroyed, closing it dropped the old
+    // registration already
+    backlogChannels_[sendFd] = channel;
+    struct epoll_event event = {};
+    event.events = EPOLLOUT | EPOLLONESHOT;
+    event.data.fd = sendFd;
+    if (epoll_ctl(backlogEpollFd_, EPOLL_CTL_ADD, sendFd, &event) != 0 &&
+        (errno != EEXIST || epoll_ctl(backlogEpollFd_, EPOLL_CTL_MOD, sendFd, &event) != 0)) {
+        SEN_HILOGE("watch backlog failed, errno : %{public}d", errno);
+        backlogChannels_.erase(sendFd);
+    }
+}
 
-    size_t eventSize = event.size();
-    std::vector<struct TransferSensorEvents> transferEvents;
-    for (size_t i = 0; i < eventSize; i++) {
-        struct TransferSensorEvents  transferEvent = {
-            .sensorTypeId = event[i].sensorTypeId,
-            .version = event[i].version,
-            .timestamp = event[i].timestamp,
-            .option = event[i].option,
-            .mode = event[i].mode,
-            .dataLen = event[i].dataLen
-        };
-        errno_t ret = memcpy_s(transferEvent.data, SENSOR_MAX_LENGTH, event[i].data, event[i].dataLen);
-        if (ret != EOK) {
-            SEN_HILOGE("copy data failed");
+void SensorDataProcesser::DrainBacklog(int32_t sendFd)
+{
+    sptr<SensorBasicDataChannel> channel = nullptr;
+    {
+        std::lock_guard<std::mutex> backlogLock(backlogMutex_);
+        auto watchIt = backlogChannels_.find(sendFd);
+        if (watchIt == backlogChannels_.end()) {
             return;
         }
-        transferEvents.push_back(transferEvent);
-    }
-    auto ret = channel->SendData(transferEvents.data(), eventSize * sizeof(struct TransferSensorEvents));
-    if (ret != ERR_OK) {
-        SEN_HILOGE("send data failed, ret : %{public}d", ret);
-        uint32_t sensorId = static_cast<uint32_t>(event[eventSize - 1].sensorTypeId);
-        if (sensorId == FLUSH_COMPLETE_ID) {
-            sensorId = static_cast<uint32_t>(event[eventSize - 1].sensorTypeId);
+        channel = watchIt->second.promote();
+        if (channel == nullptr) {
+            backlogChannels_.erase(watchIt);
+            return;
+        }
+    }
+    int32_t ret = channel->FlushBacklog();
+    channel->UpdateConsumerState();
+    std::lock_guard<std::mutex> backlogLock(backlogMutex_);
+    if (ret != ERR_OK || channel->HasBacklog()) {
+        // Still not writable enough, wait for the next EPOLLOUT
+        struct epoll_event event = {};
+        event.events = EPOLLOUT | EPOLLONESHOT;
+        event.data.fd = sendFd;
+        if (epoll_ctl(backlogEpollFd_, EPOLL_CTL_MOD, sendFd, &event) == 0) {
+            return;
         }
-        cacheBuf[sensorId] = event[eventSize - 1];
+        SEN_HILOGE("rearm backlog failed, errno : %{public}d", errno);
     }
+    epoll_ctl(backlogEpollFd_, EPOLL_CTL_DEL, sendFd, nullptr);
+    backlogChannels_.erase(sendFd);
 }
 
-int32_t SensorDataProcesser::CacheSensorEvent(const struct SensorEvent &event, sptr<SensorBasicDataChannel> &channel)
+void SensorDataProcesser::SweepBacklogChannels()
 {
-    CHKPR(channel, INVALID_POINTER);
-    int32_t ret = ERR_OK;
-    auto &cacheBuf = const_cast<std::unordered_map<uint32_t, struct SensorEvent> &>(channel->GetDataCacheBuf());
-    uint32_t sensorId = static_cast<uint32_t>(event.sensorTypeId);
-    if (sensorId == FLUSH_COMPLETE_ID) {
-        sensorId = static_cast<uint32_t>(event.sensorTypeId);
+    std::lock_guard<std::mutex> backlogLock(backlogMutex_);
+    for (auto it = backlogChannels_.begin(); it != backlogChannels_.end();) {
+        if (it->second.promote() == nullptr) {
+            it = backlogChannels_.erase(it);
+        } else {
+            it++;
+        }
+    }
+}
+
+int32_t SensorDataProcesser::BacklogThread(sptr<SensorDataProcesser> dataProcesser)
+{
+    CALL_LOG_ENTER;
+    CHKPR(dataProcesser, INVALID_POINTER);
+    if (dataProcesser->backlogEpollFd_ < 0) {
+        SEN_HILOGE("backlog epoll is not created");
+        return ERROR;
     }
-    auto cacheEvent = cacheBuf.find(sensorId);
-    if (cacheEvent != cacheBuf.end()) {
-        // Try to send the last failed value, if it still fails, replace the previous cache directly
-        ret = channel->SendData(&cacheEvent->second, sizeof(struct SensorEvent));
-        if (ret != ERR_OK) {
-            SEN_HILOGE("ret : %{public}d", ret);
+    struct epoll_event events[MAX_BACKLOG_EPOLL_EVENTS];
+    do {
+        int32_t count = epoll_wait(dataProcesser->backlogEpollFd_, events, MAX_BACKLOG_EPOLL_EVENTS,
+            BACKLOG_SWEEP_INTERVAL_MS);
+        if (count < 0 && errno != EINTR) {
+            SEN_HILOGE("epoll_wait failed, errno : %{public}d", errno);
+            return ERROR;
         }
-        ret = channel->SendData(&event, sizeof(struct SensorEvent));
-        if (ret != ERR_OK) {
-            SEN_HILOGE("ret : %{public}d", ret);
-            cacheBuf[sensorId] = event;
-        } else {
-            cacheBuf.erase(cacheEvent);
+        if (count == 0) {
+            dataProcesser->SweepBacklogChannels();
+            continue;
         }
-    } else {
-        ret = channel->SendData(&event, sizeof(struct SensorEvent));
-        if (ret != ERR_OK) {
-            SEN_HILOGE("ret : %{public}d", ret);
-            cacheBuf[sensorId] = event;
+        for (int32_t i = 0; i < count; i++) {
+            dataProcesser->DrainBacklog(events[i].data.fd);
         }
+    } while (1);
+}
+
+bool SensorDataProcesser::ConvertToTransferEvent(const struct SensorEvent &event,
+                                                 struct TransferSensorEvents &transferEvent)
+{
+    transferEvent.sensorTypeId = static_cast<uint32_t>(event.sensorTypeId);
+    transferEvent.version = event.version;
+    transferEvent.timestamp = event.timestamp;
+    transferEvent.option = static_cast<int32_t>(event.option);
+    transferEvent.mode = event.mode;
+    transferEvent.dataLen = event.dataLen;
+    errno_t ret = memcpy_s(transferEvent.data, SENSOR_MAX_LENGTH, event.data, event.dataLen);
+    if (ret != EOK) {
+        SEN_HILOGE("copy data failed, dataLen : %{public}u", event.dataLen);
+        return false;
     }
-    return ret;
+    return true;
 }
 
-void SensorDataProcesser::EventFilter(struct CircularEventBuf &eventsBuf)
+void SensorDataProcesser::EventFilter(struct SensorEvent &event, DispatchOutbox &outbox)
 {
     uint32_t realSensorId = 0;
-    uint32_t sensorId = static_cast<uint32_t>(eventsBuf.circularBuf[eventsBuf.readPos].sensorTypeId);
-    std::vector<sptr<SensorBasicDataChannel>> channelList;
+    uint32_t sensorId = static_cast<uint32_t>(event.sensorTypeId);
     if (sensorId == FLUSH_COMPLETE_ID) {
-        realSensorId = static_cast<uint32_t>(eventsBuf.circularBuf[eventsBuf.readPos].sensorTypeId);
-        channelList = clientInfo_.GetSensorChannel(realSensorId);
+        realSensorId = static_cast<uint32_t>(event.sensorTypeId);
     } else {
-        channelList = clientInfo_.GetSensorChannel(sensorId);
+        realSensorId = sensorId;
+    }
+    auto dispatchTable = clientInfo_.GetDispatchTable();
+    auto subscriberIt = dispatchTable->subscribers.find(realSensorId);
+    if (subscriberIt == dispatchTable->subscribers.end()) {
+        return;
+    }
+    const auto &subscribers = subscriberIt->second;
+    // The ring slot is recycled after this drain, everything kept past it works on an owned copy
+    struct TransferSensorEvents transferEvent;
+    if (!ConvertToTransferEvent(event, transferEvent)) {
+        return;
     }
-    auto flushInfo = flushInfo_.GetFlushInfo();
-    std::vector<struct FlushInfo> flushVec;
     if (sensorId == FLUSH_COMPLETE_ID) {
         SEN_HILOGD("sensorId : %{public}u", sensorId);
-        auto it = flushInfo.find(realSensorId);
-        if (it != flushInfo.end()) {
-            flushVec = it->second;
-            for (auto &channel : flushVec) {
-                if (flushInfo_.IsFlushChannelValid(channelList, channel.flushChannel)) {
-                    SendEvents(channel.flushChannel, eventsBuf.circularBuf[eventsBuf.readPos]);
-                    flushInfo_.ClearFlushInfoItem(realSensorId);
-                    break;
-                } else {
-                    // The channel that store in the flushVec has invalid, so erase this channel directly
-                    SEN_HILOGD("clear flush info");
-                    flushInfo_.ClearFlushInfoItem(realSensorId);
-                }
-            }
+        auto flushInfo = flushInfo_.GetFlushInfo();
+        auto it = flushInfo->find(realSensorId);
+        if (it == flushInfo->end()) {
+            return;
         }
-    } else {
-        for (auto &channel : channelList) {
-            int32_t index = flushInfo_.GetFlushChannelIndex(flushVec, channel);
-            if (index >= 0) {
-                if (flushVec[index].flushFromEnable) {
-                    SEN_HILOGI("flushFromEnable");
-                    continue;
-                }
-            }
-            /* if has some suspend flush, but this flush come from the flush function rather than enable,
-               so we need to calling GetSensorStatus to decided whether send this event. */
-            if (channel->GetSensorStatus()) {
-                SendEvents(channel, eventsBuf.circularBuf[eventsBuf.readPos]);
+        for (const auto &flush : it->second) {
+            const SubscriberRecord *flushSubscriber = flushInfo_.FindFlushSubscriber(subscribers, flush.flushChannel);
+            if (flushSubscriber != nullptr) {
+                SendEvents(*flushSubscriber, transferEvent, outbox);
+                flushInfo_.ClearFlushInfoItem(realSensorId);
+                break;
+            } else {
+                // The channel that store in the flushVec has invalid, so erase this channel directly
+                SEN_HILOGD("clear flush info");
+                flushInfo_.ClearFlushInfoItem(realSensorId);
             }
         }
+        return;
+    }
+    // Kept once per event however many subscribers get it, only this worker ever writes the slot of the sensor
+    clientInfo_.StoreEvent(transferEvent);
+    for (const auto &subscriber : subscribers) {
+        if (subscriber.channel->GetSensorStatus()) {
+            SendEvents(subscriber, transferEvent, outbox);
+        }
     }
 }
 
-int32_t SensorDataProcesser::ProcessEvents(sptr<ReportDataCallback> dataCallback)
+int32_t SensorDataProcesser::ProcessEvents(sptr<ReportDataCallback> dataCallback, uint32_t ringIndex,
+                                           DispatchOutbox &outbox)
 {
     CHKPR(dataCallback, INVALID_POINTER);
-    std::unique_lock<std::mutex> lk(ISensorHdiConnection::dataMutex_);
-    ISensorHdiConnection::dataCondition_.wait(lk);
-    auto &eventsBuf = dataCallback->GetEventData();
-    if (eventsBuf.eventNum <= 0) {
+    auto &eventsRing = dataCallback->GetEventData(ringIndex);
+    eventsRing.WaitForData();
+    uint32_t eventNum = eventsRing.Available();
+    if (eventNum == 0) {
         SEN_HILOGE("data cannot be empty");
         return NO_EVENT;
     }
-    int32_t eventNum = eventsBuf.eventNum;
-    for (int32_t i = 0; i < eventNum; i++) {
-        EventFilter(eventsBuf);
-        delete[] eventsBuf.circularBuf[eventsBuf.readPos].data;
-        eventsBuf.readPos++;
-        if (eventsBuf.readPos == CIRCULAR_BUF_LEN) {
-            eventsBuf.readPos = 0;
-        }
-        eventsBuf.eventNum--;
+    for (uint32_t i = 0; i < eventNum; i++) {
+        EventFilter(eventsRing.At(i), outbox);
     }
+    FlushOutbox(outbox);
+    eventsRing.Consume(eventNum);
     return SUCCESS;
 }
 
-int32_t SensorDataProcesser::SendEvents(sptr<SensorBasicDataChannel> &channel, struct SensorEvent &event)
+int32_t SensorDataProcesser::SendEvents(const SubscriberRecord &subscriber, struct TransferSensorEvents &event,
+                                        DispatchOutbox &outbox)
 {
+    const auto &channel = subscriber.channel;
     CHKPR(channel, INVALID_POINTER);
-    clientInfo_.UpdateDataQueue(event.sensorTypeId, event);
-    auto &cacheBuf = channel->GetDataCacheBuf();
-    if (cacheBuf.empty()) {
-        ReportData(channel, event);
+    if (channel->GetConsumerState() == CONSUMER_PAUSED) {
+        // The client has not read for a while, do not spend any work on its events until it drains
+        channel->CountPausedDrop(1);
+    } else if (!RenewPermission(subscriber, event.sensorTypeId)) {
+        // Revoked since the table was built, the change callback takes the subscriber out of the table
+        SEN_HILOGD("permission of sensorTypeId:%{public}d is revoked, drop event", event.sensorTypeId);
     } else {
-        CacheSensorEvent(event, channel);
+        ReportData(subscriber, event, outbox);
     }
-    clientInfo_.StoreEvent(event);
     return SUCCESS;
 }
 
-int32_t SensorDataProcesser::DataThread(sptr<SensorDataProcesser> dataProcesser, sptr<ReportDataCallback> dataCallback)
+bool SensorDataProcesser::RenewPermission(const SubscriberRecord &subscriber, int32_t sensorTypeId)
+{
+    const auto &dispatchState = subscriber.dispatchState;
+    CHKPF(dispatchState);
+    // Only asks PermissionUtil once the grant the table was built with is older than its time to live
+    return PermissionUtil::GetInstance().RenewSensorPermission(subscriber.callerToken, sensorTypeId,
+        dispatchState->GetGrantExpiry());
+}
+
+int32_t SensorDataProcesser::DataThread(sptr<SensorDataProcesser> dataProcesser, sptr<ReportDataCallback> dataCallback,
+                                        uint32_t ringIndex, int32_t cpuId)
 {
     CALL_LOG_ENTER;
+    if (cpuId >= 0) {
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        CPU_SET(cpuId, &cpuSet);
+        if (sched_setaffinity(0, sizeof(cpuSet), &cpuSet) != 0) {
+            SEN_HILOGW("set affinity failed, ringIndex : %{public}u, cpuId : %{public}d", ringIndex, cpuId);
+        }
+    }
+    DispatchOutbox outbox;
     do {
-        if (dataProcesser->ProcessEvents(dataCallback) == INVALID_POINTER) {
+        if (dataProcesser->ProcessEvents(dataCallback, ringIndex, outbox) == INVALID_POINTER) {
             SEN_HILOGE("callback cannot be null");
             return INVALID_POINTER;
         }
@@ -18,6 +18,7 @@
 #include <cinttypes>
 #include <ctime>
 #include <queue>
+#include <unordered_set>
 
 #include "sensors_errors.h"
 #include "sensors_log_domain.h"
@@ -131,6 +132,7 @@ void SensorDump::DumpHelp(int32_t fd)
     dprintf(fd, "      -c: dump the sensor data channel info\n");
     dprintf(fd, "      -o: dump the opening sensors\n");
     dprintf(fd, "      -d: dump the last 10 packages sensor data\n");
+    dprintf(fd, "      -p: dump the sensor data path statistics\n");
 }
 
 bool SensorDump::DumpSensorList(int32_t fd, const std::vector<Sensor> &sensors, const std::vector<std::u16string> &args)
@@ -176,6 +178,21 @@ bool SensorDump::DumpSensorChannel(int32_t fd, ClientInfo &clientInfo, const std
                 channel.GetUid(), channel.GetPackageName().c_str(), sensorId, sensorMap_[sensorId].c_str(),
                 int32_t { channel.GetSamplingPeriodNs() }, channel.GetFifoCount(), cmds.c_str());
     }
+    dprintf(fd, "Sensor channel backlog:\n");
+    auto dispatchTable = clientInfo.GetDispatchTable();
+    std::unordered_set<int32_t> dumpedPids;
+    for (const auto &subscribersIt : dispatchTable->subscribers) {
+        for (const auto &subscriber : subscribersIt.second) {
+            if (!dumpedPids.insert(subscriber.pid).second) {
+                continue;
+            }
+            const auto &channel = subscriber.channel;
+            dprintf(fd,
+                    "pid:%d | uid:%d | format:%d | state:%d | backlog:%zu | dropped:%" PRIu64 " | degraded:%" PRIu64
+                    "\n", subscriber.pid, subscriber.uid, channel->GetWireFormat(), channel->GetConsumerState(),
+                    channel->GetBacklogSize(), channel->GetBacklogDroppedCount(), channel->GetDegradedCount());
+        }
+    }
     return true;
 }
 
@@ -223,6 +240,26 @@ bool SensorDump::DumpSensorData(int32_t fd, ClientInfo &clientInfo, const std::v
     return true;
 }
 
+bool SensorDump::DumpDataPath(int32_t fd, sptr<ReportDataCallback> dataCallback,
+                              const std::vector<std::u16string> &args)
+{
+    if ((args.empty()) || (args[0].compare(u"-p") != 0)) {
+        SEN_HILOGE("args cannot be empty or invalid");
+        return false;
+    }
+    CHKPF(dataCallback);
+    DumpCurrentTime(fd);
+    dprintf(fd, "Sensor data path:\n");
+    for (uint32_t i = 0; i < dataCallback->GetEventRingCount(); i++) {
+        auto &eventsRing = dataCallback->GetEventData(i);
+        dprintf(fd,
+                "eventRing:%u | capacity:%u | pending:%u | dropped:%" PRIu64 " | payloadAllocations:%" PRIu64 "\n",
+                i, eventsRing.GetCapacity(), eventsRing.Available(), eventsRing.GetDroppedCount(),
+                eventsRing.GetPayloadAllocCount());
+    }
+    return true;
+}
+
 void SensorDump::DumpCurrentTime(int32_t fd)
 {
     timespec curTime = { 0, 0 };
@@ -260,7 +297,7 @@ int32_t SensorDump::DataSizeBySensorId(uint32_t sensorId)
     }
 }
 
-std::string SensorDump::GetDataBySensorId(uint32_t sensorId, struct SensorEvent &sensorData)
+std::string SensorDump::GetDataBySensorId(uint32_t sensorId, struct TransferSensorEvents &sensorData)
 {
     SEN_HILOGD("sensorId: %{public}u", sensorId);
     std::string buffer;
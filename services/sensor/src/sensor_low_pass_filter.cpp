@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sensor_low_pass_filter.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+
+#include "securec.h"
+#include "sensors_errors.h"
+#include "sensors_log_domain.h"
+
+namespace OHOS {
+namespace Sensors {
+using namespace OHOS::HiviewDFX;
+
+namespace {
+constexpr HiLogLabel LABEL = { LOG_CORE, SensorsLogDomain::SENSOR_SERVICE, "SensorLowPassFilter" };
+// Cutoff relative to the delivered rate, kept below its Nyquist frequency of 0.5
+constexpr double CUTOFF_RATIO = 0.4;
+constexpr double MAX_NORMALIZED_CUTOFF = 0.45;
+constexpr double BUTTERWORTH_Q = 0.7071067811865476;
+constexpr double PI = 3.14159265358979323846;
+}  // namespace
+
+void SensorLowPassFilter::Configure(int64_t inputPeriodNs, int64_t outputPeriodNs)
+{
+    if (inputPeriodNs == inputPeriodNs_ && outputPeriodNs == outputPeriodNs_) {
+        return;
+    }
+    inputPeriodNs_ = inputPeriodNs;
+    outputPeriodNs_ = outputPeriodNs;
+    primed_ = false;
+    if (inputPeriodNs <= 0 || outputPeriodNs <= inputPeriodNs) {
+        // Not downsampled, nothing above the delivered Nyquist frequency to remove
+        b0_ = 1.0f;
+        b1_ = b2_ = a1_ = a2_ = 0.0f;
+        return;
+    }
+    double normalizedCutoff = CUTOFF_RATIO * static_cast<double>(inputPeriodNs) / static_cast<double>(outputPeriodNs);
+    normalizedCutoff = std::min(normalizedCutoff, MAX_NORMALIZED_CUTOFF);
+    double omega = 2.0 * PI * normalizedCutoff;
+    double alpha = std::sin(omega) / (2.0 * BUTTERWORTH_Q);
+    double cosOmega = std::cos(omega);
+    double a0 = 1.0 + alpha;
+    b0_ = static_cast<float>((1.0 - cosOmega) / 2.0 / a0);
+    b1_ = static_cast<float>((1.0 - cosOmega) / a0);
+    b2_ = b0_;
+    a1_ = static_cast<float>(-2.0 * cosOmega / a0);
+    a2_ = static_cast<float>((1.0 - alpha) / a0);
+    SEN_HILOGD("inputPeriodNs : %{public}" PRId64 ", outputPeriodNs : %{public}" PRId64, inputPeriodNs,
+        outputPeriodNs);
+}
+
+void SensorLowPassFilter::Reset(const float *input, size_t axisCount)
+{
+    // Start from the steady state of the first sample so the output does not ramp up from zero
+    for (size_t i = 0; i < axisCount; i++) {
+        z1_[i] = input[i] * (1.0f - b0_);
+        z2_[i] = input[i] * (b2_ - a2_);
+    }
+    axisCount_ = axisCount;
+    primed_ = true;
+}
+
+void SensorLowPassFilter::Update(const struct TransferSensorEvents &event)
+{
+    output_ = event;
+    if (event.dataLen == 0 || event.dataLen > SENSOR_MAX_LENGTH || (event.dataLen % sizeof(float)) != 0) {
+        return;
+    }
+    size_t axisCount = event.dataLen / sizeof(float);
+    float input[MAX_AXIS_COUNT];
+    float filtered[MAX_AXIS_COUNT];
+    if (memcpy_s(input, sizeof(input), event.data, event.dataLen) != EOK) {
+        SEN_HILOGE("copy input failed");
+        return;
+    }
+    if (!primed_ || axisCount != axisCount_) {
+        Reset(input, axisCount);
+    }
+    // Axes are independent, the loop body has no cross-iteration dependency and is vectorized by the compiler
+    for (size_t i = 0; i < axisCount; i++) {
+        float y = b0_ * input[i] + z1_[i];
+        z1_[i] = b1_ * input[i] - a1_ * y + z2_[i];
+        z2_[i] = b2_ * input[i] - a2_ * y;
+        filtered[i] = y;
+    }
+    if (memcpy_s(output_.data, sizeof(output_.data), filtered, event.dataLen) != EOK) {
+        SEN_HILOGE("copy output failed");
+        output_ = event;
+    }
+}
+
+const struct TransferSensorEvents &SensorLowPassFilter::GetOutput() const
+{
+    return output_;
+}
+}  // namespace Sensors
+}  // namespace OHOS
@@ -24,6 +24,9 @@ namespace Sensors {
 using namespace OHOS::HiviewDFX;
 
 namespace {
+#ifndef SENSOR_DISPATCH_CPU_BASE
+#define SENSOR_DISPATCH_CPU_BASE (-1)
+#endif  // SENSOR_DISPATCH_CPU_BASE
 constexpr HiLogLabel LABEL = { LOG_CORE, SensorsLogDomain::SENSOR_SERVICE, "SensorManager" };
 constexpr uint32_t INVALID_SENSOR_ID = -1;
 constexpr uint32_t PROXIMITY_SENSOR_ID = 50331904;
@@ -134,17 +137,26 @@ ErrCode SensorManager::SaveSubscriber(uint32_t sensorId, uint32_t pid, int64_t s
         SEN_HILOGE("UpdateSensorInfo is failed");
         return UPDATE_SENSOR_INFO_ERR;
     }
+    clientInfo_.ResizeChannelBuffer(pid);
     return ERR_OK;
 }
 
 void SensorManager::StartDataReportThread()
 {
     CALL_LOG_ENTER;
-    if (!dataThread_.joinable()) {
-        SEN_HILOGW("dataThread_ started");
-        std::thread senocdDataThread(SensorDataProcesser::DataThread, sensorDataProcesser_, reportDataCallback_);
-        dataThread_ = std::move(senocdDataThread);
+    if (!dataThreads_.empty()) {
+        SEN_HILOGW("dataThreads_ already started");
+        return;
     }
+    CHKPV(reportDataCallback_);
+    // One worker per ingest ring, a sensor always hashes to the same ring so its events stay in order
+    uint32_t workerCount = reportDataCallback_->GetEventRingCount();
+    for (uint32_t i = 0; i < workerCount; i++) {
+        int32_t cpuId = (SENSOR_DISPATCH_CPU_BASE < 0) ? -1 : (SENSOR_DISPATCH_CPU_BASE + static_cast<int32_t>(i));
+        dataThreads_.emplace_back(SensorDataProcesser::DataThread, sensorDataProcesser_, reportDataCallback_, i, cpuId);
+    }
+    dataThreads_.emplace_back(SensorDataProcesser::BacklogThread, sensorDataProcesser_);
+    SEN_HILOGI("dataThreads_ started, workerCount : %{public}u", workerCount);
 }
 
 bool SensorManager::IsOtherClientUsingSensor(uint32_t sensorId, int32_t clientPid)
@@ -167,7 +179,7 @@ ErrCode SensorManager::AfterDisableSensor(uint32_t sensorId)
     CALL_LOG_ENTER;
     clientInfo_.ClearSensorInfo(sensorId);
     if (sensorId == PROXIMITY_SENSOR_ID) {
-        struct SensorEvent event;
+        struct TransferSensorEvents event;
         auto ret = clientInfo_.GetStoreEvent(sensorId, event);
         if (ret == ERR_OK) {
             SEN_HILOGD("change the default state is far");
@@ -34,6 +34,15 @@ namespace Sensors {
 using namespace OHOS::HiviewDFX;
 
 namespace {
+#ifndef SENSOR_DISPATCH_WORKER_COUNT
+#define SENSOR_DISPATCH_WORKER_COUNT 1
+#endif  // SENSOR_DISPATCH_WORKER_COUNT
+#ifndef SENSOR_CHANNEL_BACKLOG_CAPACITY
+#define SENSOR_CHANNEL_BACKLOG_CAPACITY 256
+#endif  // SENSOR_CHANNEL_BACKLOG_CAPACITY
+#ifndef SENSOR_CHANNEL_BACKLOG_POLICY
+#define SENSOR_CHANNEL_BACKLOG_POLICY BACKLOG_DROP_OLDEST
+#endif  // SENSOR_CHANNEL_BACKLOG_POLICY
 constexpr HiLogLabel LABEL = { LOG_CORE, SensorsLogDomain::SENSOR_SERVICE, "SensorService" };
 constexpr uint32_t INVALID_SENSOR_ID = -1;
 constexpr int32_t MAX_DMUP_PARAM = 2;
@@ -79,6 +88,11 @@ void SensorService::OnStart()
     }
     sensorDataProcesser_ = new (std::nothrow) SensorDataProcesser(sensorMap_);
     CHKPV(sensorDataProcesser_);
+    PermissionUtil::GetInstance().SetPermissionChangedCallback(
+        [this](AccessTokenID callerToken, int32_t sensorTypeId, bool granted) {
+            clientInfo_.OnPermissionChanged(callerToken, sensorTypeId, granted);
+        });
+    PermissionUtil::GetInstance().StartPermissionMonitor();
     if (!InitSensorPolicy()) {
         SEN_HILOGE("Init sensor policy error");
     }
@@ -103,7 +117,7 @@ bool SensorService::InitInterface()
 
 bool SensorService::InitDataCallback()
 {
-    reportDataCallback_ = new (std::nothrow) ReportDataCallback();
+    reportDataCallback_ = new (std::nothrow) ReportDataCallback(SENSOR_DISPATCH_WORKER_COUNT);
     CHKPF(reportDataCallback_);
     ZReportDataCb cb = &ReportDataCallback::ReportEventCallback;
     auto ret = sensorHdiConnection_.RegisteDataReport(cb, reportDataCallback_);
@@ -130,6 +144,7 @@ bool SensorService::InitSensorList()
             }
         }
     }
+    clientInfo_.InitStoredEvents(sensors_);
     return true;
 }
 
@@ -146,6 +161,7 @@ void SensorService::OnStop()
         return;
     }
     state_ = SensorServiceState::STATE_STOPPED;
+    PermissionUtil::GetInstance().StopPermissionMonitor();
     int32_t ret = sensorHdiConnection_.DestroyHdiConnection();
     if (ret != ERR_OK) {
         SEN_HILOGE("destroy hdi connect fail");
@@ -195,7 +211,7 @@ void SensorService::ReportOnChangeData(uint32_t sensorId)
         SEN_HILOGW("it is not onchange data, no need to report");
         return;
     }
-    struct SensorEvent event;
+    struct TransferSensorEvents event;
     auto ret = clientInfo_.GetStoreEvent(sensorId, event);
     if (ret != ERR_OK) {
         SEN_HILOGE("there is no data to be reported");
@@ -364,10 +380,14 @@ ErrCode SensorService::TransferDataChannel(const sptr<SensorBasicDataChannel> &s
         SEN_HILOGE("UpdateUid is failed");
         return UPDATE_UID_ERR;
     }
+    // Enable verifies on its own, the new channel must not inherit grants older than this call either
+    PermissionUtil::GetInstance().RefreshPermissionCache(callerToken);
     if (!clientInfo_.UpdateSensorChannel(pid, sensorBasicDataChannel)) {
         SEN_HILOGE("UpdateSensorChannel is failed");
         return UPDATE_SENSOR_CHANNEL_ERR;
     }
+    sensorBasicDataChannel->SetBacklogPolicy(static_cast<BacklogPolicy>(SENSOR_CHANNEL_BACKLOG_POLICY),
+        SENSOR_CHANNEL_BACKLOG_CAPACITY);
     sensorBasicDataChannel->SetSensorStatus(true);
     RegisterClientDeathRecipient(sensorClient, pid);
     return ERR_OK;
@@ -393,6 +413,38 @@ ErrCode SensorService::DestroySensorChannel(sptr<IRemoteObject> sensorClient)
     return ERR_OK;
 }
 
+ErrCode SensorService::SetSensorOption(uint32_t sensorId, int32_t option)
+{
+    CALL_LOG_ENTER;
+    if ((sensorId == INVALID_SENSOR_ID) || (option < SENSOR_OPTION_DEFAULT) || (option >= SENSOR_OPTION_MAX)) {
+        SEN_HILOGE("sensorId or option is invalid, option : %{public}d", option);
+        return SET_SENSOR_OPTION_ERR;
+    }
+    const int32_t clientPid = this->GetCallingPid();
+    if (clientPid < 0) {
+        SEN_HILOGE("clientPid is invalid, clientPid : %{public}d", clientPid);
+        return CLIENT_PID_INVALID_ERR;
+    }
+    float quantum = 0.0f;
+    if ((static_cast<uint32_t>(option) & SENSOR_OPTION_DELTA_ENCODING) != 0) {
+        std::lock_guard<std::mutex> sensorMapLock(sensorMapMutex_);
+        auto sensorIt = sensorMap_.find(sensorId);
+        if (sensorIt == sensorMap_.end() || sensorIt->second.GetResolution() <= 0.0f) {
+            SEN_HILOGE("delta encoding needs the sensor resolution, sensorId : %{public}u", sensorId);
+            return SET_SENSOR_OPTION_ERR;
+        }
+        quantum = sensorIt->second.GetResolution();
+    }
+    sptr<SensorBasicDataChannel> channel = clientInfo_.GetSensorChannelByPid(clientPid);
+    CHKPR(channel, SET_SENSOR_OPTION_ERR);
+    if (quantum > 0.0f && channel->GetWireFormat() < WIRE_FORMAT_COMPACT_DELTA) {
+        SEN_HILOGW("client can not decode deltas, events stay lossless, pid : %{public}d", clientPid);
+    }
+    channel->SetDeltaQuantum(sensorId, quantum);
+    clientInfo_.UpdateSensorOption(sensorId, clientPid, option);
+    return ERR_OK;
+}
+
 void SensorService::ProcessDeathObserver(const wptr<IRemoteObject> &object)
 {
     CALL_LOG_ENTER;
@@ -444,7 +496,8 @@ int32_t SensorService::Dump(int32_t fd, const std::vector<std::u16string> &args)
     bool channelRet = sensorDump.DumpSensorChannel(fd, clientInfo_, args);
     bool openRet = sensorDump.DumpOpeningSensor(fd, sensors_, clientInfo_, args);
     bool dataRet = sensorDump.DumpSensorData(fd, clientInfo_, args);
-    bool total = helpRet + listRet + channelRet + openRet + dataRet;
+    bool pathRet = sensorDump.DumpDataPath(fd, reportDataCallback_, args);
+    bool total = helpRet + listRet + channelRet + openRet + dataRet + pathRet;
     if (!total) {
         dprintf(fd, "cmd param is error\n");
         sensorDump.DumpHelp(fd);
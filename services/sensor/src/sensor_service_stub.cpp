@@ -15,6 +15,7 @@
 
 #include "sensor_service_stub.h"
 
+#include <algorithm>
 #include <string>
 #include <sys/socket.h>
 #include <unistd.h>
@@ -45,6 +46,7 @@ SensorServiceStub::SensorServiceStub()
     baseFuncs_[GET_SENSOR_LIST] = &SensorServiceStub::GetAllSensorsInner;
     baseFuncs_[TRANSFER_DATA_CHANNEL] = &SensorServiceStub::CreateDataChannelInner;
     baseFuncs_[DESTROY_SENSOR_CHANNEL] = &SensorServiceStub::DestroyDataChannelInner;
+    baseFuncs_[SET_SENSOR_OPTION] = &SensorServiceStub::SetSensorOptionInner;
 }
 
 SensorServiceStub::~SensorServiceStub()
@@ -140,7 +142,6 @@ ErrCode SensorServiceStub::GetAllSensorsInner(MessageParcel &data, MessageParcel
 
 ErrCode SensorServiceStub::CreateDataChannelInner(MessageParcel &data, MessageParcel &reply)
 {
-    (void)reply;
     sptr<SensorBasicDataChannel> sensorChannel = new (std::nothrow) SensorBasicDataChannel();
     CHKPR(sensorChannel, OBJECT_NULL);
     auto ret = sensorChannel->CreateSensorBasicChannel(data);
@@ -150,7 +151,17 @@ ErrCode SensorServiceStub::CreateDataChannelInner(MessageParcel &data, MessagePa
     }
     sptr<IRemoteObject> sensorClient = data.ReadRemoteObject();
     CHKPR(sensorClient, OBJECT_NULL);
-    return TransferDataChannel(sensorChannel, sensorClient);
+    // Clients that predate the negotiation do not write a format, reading past the end gives the legacy one
+    sensorChannel->SetWireFormat(std::min(data.ReadInt32(), static_cast<int32_t>(WIRE_FORMAT_MAX - 1)));
+    ret = TransferDataChannel(sensorChannel, sensorClient);
+    if (ret != ERR_OK) {
+        return ret;
+    }
+    if (!reply.WriteInt32(sensorChannel->GetWireFormat())) {
+        SEN_HILOGE("write wire format failed");
+        return WRITE_MSG_ERR;
+    }
+    return ERR_OK;
 }
 
 ErrCode SensorServiceStub::DestroyDataChannelInner(MessageParcel &data, MessageParcel &reply)
@@ -159,5 +170,17 @@ ErrCode SensorServiceStub::DestroyDataChannelInner(MessageParcel &data, MessageP
     CHKPR(sensorClient, OBJECT_NULL);
     return DestroySensorChannel(sensorClient);
 }
+
+ErrCode SensorServiceStub::SetSensorOptionInner(MessageParcel &data, MessageParcel &reply)
+{
+    (void)reply;
+    uint32_t sensorId = data.ReadUint32();
+    PermissionUtil &permissionUtil = PermissionUtil::GetInstance();
+    if (!permissionUtil.CheckSensorPermission(this->GetCallingTokenID(), sensorId)) {
+        SEN_HILOGE("permission denied");
+        return ERR_PERMISSION_DENIED;
+    }
+    return SetSensorOption(sensorId, data.ReadInt32());
+}
 }  // namespace Sensors
 }  // namespace OHOS
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include "fifo_cache_data.h"
+
+namespace OHOS {
+namespace Sensors {
+using namespace testing::ext;
+
+namespace {
+constexpr int64_t NS_PER_SECOND = 1000000000;
+constexpr int64_t INPUT_PERIOD_NS = 10000000;
+constexpr int64_t JITTER_NS = 2000000;
+constexpr int64_t TOLERANCE_NS = INPUT_PERIOD_NS / 2;
+constexpr int32_t INPUT_SAMPLE_COUNT = 1000;
+constexpr uint32_t JITTER_SEED = 20211018;
+}  // namespace
+
+class FifoCacheDataTest : public testing::Test {
+public:
+    static void SetUpTestCase();
+    static void TearDownTestCase();
+    void SetUp();
+    void TearDown();
+};
+
+void FifoCacheDataTest::SetUpTestCase()
+{}
+
+void FifoCacheDataTest::TearDownTestCase()
+{}
+
+void FifoCacheDataTest::SetUp()
+{}
+
+void FifoCacheDataTest::TearDown()
+{}
+
+// Feeds ten seconds of 100 Hz input with up to 2 ms of jitter and counts the samples let through
+int32_t CountDueSamples(int64_t samplingPeriodNs)
+{
+    sptr<FifoCacheData> fifoCacheData = new (std::nothrow) FifoCacheData();
+    if (fifoCacheData == nullptr) {
+        return -1;
+    }
+    std::mt19937 generator(JITTER_SEED);
+    std::uniform_int_distribution<int64_t> jitter(-JITTER_NS, JITTER_NS);
+    int32_t dueCount = 0;
+    for (int32_t i = 0; i < INPUT_SAMPLE_COUNT; i++) {
+        int64_t timestamp = NS_PER_SECOND + i * INPUT_PERIOD_NS + jitter(generator);
+        if (fifoCacheData->IsSampleDue(timestamp, samplingPeriodNs, TOLERANCE_NS)) {
+            dueCount++;
+        }
+    }
+    return dueCount;
+}
+
+/*
+ * Feature: sensor
+ * Function: IsSampleDue
+ * FunctionPoints: Check the decimated rate of a client slower than the hardware
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: 100 Hz input with +/-2 ms jitter, a 40 Hz client gets exactly 40 samples per second.
+ */
+HWTEST_F(FifoCacheDataTest, FifoCacheDataTest_001, TestSize.Level1)
+{
+    ASSERT_EQ(CountDueSamples(NS_PER_SECOND / 40), 400);
+}
+
+/*
+ * Feature: sensor
+ * Function: IsSampleDue
+ * FunctionPoints: Check a rate that is not an integer divisor of the hardware rate
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: 100 Hz input with +/-2 ms jitter, a 30 Hz client gets exactly 30 samples per second.
+ */
+HWTEST_F(FifoCacheDataTest, FifoCacheDataTest_002, TestSize.Level1)
+{
+    ASSERT_EQ(CountDueSamples(NS_PER_SECOND / 30), 300);
+}
+
+/*
+ * Feature: sensor
+ * Function: IsSampleDue
+ * FunctionPoints: Check that a client at or above the hardware rate gets every sample
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: The requested period equals the input period or is unset, nothing is dropped.
+ */
+HWTEST_F(FifoCacheDataTest, FifoCacheDataTest_003, TestSize.Level1)
+{
+    ASSERT_EQ(CountDueSamples(INPUT_PERIOD_NS), INPUT_SAMPLE_COUNT);
+    ASSERT_EQ(CountDueSamples(0), INPUT_SAMPLE_COUNT);
+}
+
+/*
+ * Feature: sensor
+ * Function: IsSampleDue
+ * FunctionPoints: Check that a gap in the stream does not burst
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: After a one second gap the next sample is delivered once and the schedule restarts from it.
+ */
+HWTEST_F(FifoCacheDataTest, FifoCacheDataTest_004, TestSize.Level1)
+{
+    sptr<FifoCacheData> fifoCacheData = new (std::nothrow) FifoCacheData();
+    ASSERT_NE(fifoCacheData, nullptr);
+    int64_t samplingPeriodNs = NS_PER_SECOND / 40;
+    ASSERT_TRUE(fifoCacheData->IsSampleDue(NS_PER_SECOND, samplingPeriodNs, TOLERANCE_NS));
+    int64_t resumeTimestamp = 2 * NS_PER_SECOND;
+    ASSERT_TRUE(fifoCacheData->IsSampleDue(resumeTimestamp, samplingPeriodNs, TOLERANCE_NS));
+    ASSERT_FALSE(fifoCacheData->IsSampleDue(resumeTimestamp + INPUT_PERIOD_NS, samplingPeriodNs, TOLERANCE_NS));
+    // Due at +25 ms, the +20 ms sample is within half an input period of it
+    ASSERT_TRUE(fifoCacheData->IsSampleDue(resumeTimestamp + 2 * INPUT_PERIOD_NS, samplingPeriodNs, TOLERANCE_NS));
+    ASSERT_FALSE(fifoCacheData->IsSampleDue(resumeTimestamp + 3 * INPUT_PERIOD_NS, samplingPeriodNs,
+        TOLERANCE_NS));
+}
+
+/*
+ * Feature: sensor
+ * Function: IsSampleDue
+ * FunctionPoints: Check a stream whose clock restarts
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: The timestamps jump back to zero mid-stream, as when the sensor is re-enabled, the first sample
+ *                  after the jump is delivered and the 40 Hz rate holds on the new clock.
+ */
+HWTEST_F(FifoCacheDataTest, FifoCacheDataTest_005, TestSize.Level1)
+{
+    sptr<FifoCacheData> fifoCacheData = new (std::nothrow) FifoCacheData();
+    ASSERT_NE(fifoCacheData, nullptr);
+    int64_t samplingPeriodNs = NS_PER_SECOND / 40;
+    for (int32_t i = 0; i < INPUT_SAMPLE_COUNT; i++) {
+        fifoCacheData->IsSampleDue(NS_PER_SECOND + i * INPUT_PERIOD_NS, samplingPeriodNs, TOLERANCE_NS);
+    }
+    ASSERT_TRUE(fifoCacheData->IsSampleDue(INPUT_PERIOD_NS, samplingPeriodNs, TOLERANCE_NS));
+    int32_t dueCount = 1;
+    for (int32_t i = 2; i <= INPUT_SAMPLE_COUNT; i++) {
+        if (fifoCacheData->IsSampleDue(i * INPUT_PERIOD_NS, samplingPeriodNs, TOLERANCE_NS)) {
+            dueCount++;
+        }
+    }
+    ASSERT_EQ(dueCount, 400);
+}
+
+/*
+ * Feature: sensor
+ * Function: IsSampleDue
+ * FunctionPoints: Check a change of the requested rate mid-stream
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: A 40 Hz client switches to 10 Hz, the sample already due at the old rate is delivered and the
+ *                  next one follows a full 10 Hz period later, with no burst and no extra gap.
+ */
+HWTEST_F(FifoCacheDataTest, FifoCacheDataTest_006, TestSize.Level1)
+{
+    sptr<FifoCacheData> fifoCacheData = new (std::nothrow) FifoCacheData();
+    ASSERT_NE(fifoCacheData, nullptr);
+    int64_t fastPeriodNs = NS_PER_SECOND / 40;
+    int64_t slowPeriodNs = NS_PER_SECOND / 10;
+    std::vector<int64_t> delivered;
+    for (int32_t i = 0; i < 100; i++) {
+        int64_t timestamp = NS_PER_SECOND + i * INPUT_PERIOD_NS;
+        int64_t samplingPeriodNs = (i < 50) ? fastPeriodNs : slowPeriodNs;
+        if (fifoCacheData->IsSampleDue(timestamp, samplingPeriodNs, TOLERANCE_NS)) {
+            delivered.push_back(timestamp);
+        }
+    }
+    auto switchIt = std::find_if(delivered.begin(), delivered.end(),
+        [](int64_t timestamp) { return timestamp >= NS_PER_SECOND + 50 * INPUT_PERIOD_NS; });
+    ASSERT_NE(switchIt, delivered.end());
+    for (auto it = switchIt + 1; it != delivered.end(); ++it) {
+        ASSERT_EQ(*it - *(it - 1), slowPeriodNs);
+    }
+    ASSERT_LE(*switchIt - *(switchIt - 1), slowPeriodNs);
+}
+}  // namespace Sensors
+}  // namespace OHOS
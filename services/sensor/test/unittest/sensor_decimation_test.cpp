@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "sensor_decimation.h"
+
+namespace OHOS {
+namespace Sensors {
+using namespace testing::ext;
+
+namespace {
+constexpr int64_t NS_PER_SECOND = 1000000000;
+constexpr int64_t INPUT_PERIOD_NS = 10000000;
+constexpr int64_t SAMPLING_PERIOD_NS = 4 * INPUT_PERIOD_NS;
+constexpr int64_t TOLERANCE_NS = INPUT_PERIOD_NS / 2;
+}  // namespace
+
+class SensorDecimationTest : public testing::Test {
+public:
+    static void SetUpTestCase();
+    static void TearDownTestCase();
+    void SetUp();
+    void TearDown();
+};
+
+void SensorDecimationTest::SetUpTestCase()
+{}
+
+void SensorDecimationTest::TearDownTestCase()
+{}
+
+void SensorDecimationTest::SetUp()
+{}
+
+void SensorDecimationTest::TearDown()
+{}
+
+/*
+ * Feature: sensor
+ * Function: IsSampleDue
+ * FunctionPoints: Check a timestamp that goes backwards
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: A repeated timestamp is dropped without touching the schedule, a sample older than the last
+ *                  delivered one restarts the schedule from it.
+ */
+HWTEST_F(SensorDecimationTest, SensorDecimationTest_001, TestSize.Level1)
+{
+    int64_t nextDueTimestamp = 0;
+    ASSERT_TRUE(SensorDecimation::IsSampleDue(nextDueTimestamp, NS_PER_SECOND, SAMPLING_PERIOD_NS, TOLERANCE_NS));
+    ASSERT_FALSE(SensorDecimation::IsSampleDue(nextDueTimestamp, NS_PER_SECOND, SAMPLING_PERIOD_NS, TOLERANCE_NS));
+    ASSERT_EQ(nextDueTimestamp, NS_PER_SECOND + SAMPLING_PERIOD_NS);
+
+    // The clock of the stream was reset, e.g. the sensor was re-enabled
+    int64_t resetTimestamp = INPUT_PERIOD_NS;
+    ASSERT_TRUE(SensorDecimation::IsSampleDue(nextDueTimestamp, resetTimestamp, SAMPLING_PERIOD_NS, TOLERANCE_NS));
+    ASSERT_EQ(nextDueTimestamp, resetTimestamp + SAMPLING_PERIOD_NS);
+}
+
+/*
+ * Feature: sensor
+ * Function: IsSampleDue
+ * FunctionPoints: Check that the schedule does not drift with late samples
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: Every due sample arrives just inside the tolerance, the next due time still advances by exactly
+ *                  one period from the previous due time.
+ */
+HWTEST_F(SensorDecimationTest, SensorDecimationTest_002, TestSize.Level1)
+{
+    int64_t nextDueTimestamp = 0;
+    ASSERT_TRUE(SensorDecimation::IsSampleDue(nextDueTimestamp, NS_PER_SECOND, SAMPLING_PERIOD_NS, TOLERANCE_NS));
+    for (int64_t i = 1; i <= 10; i++) {
+        int64_t dueTimestamp = NS_PER_SECOND + i * SAMPLING_PERIOD_NS;
+        ASSERT_EQ(nextDueTimestamp, dueTimestamp);
+        ASSERT_TRUE(SensorDecimation::IsSampleDue(nextDueTimestamp, dueTimestamp + TOLERANCE_NS - 1,
+            SAMPLING_PERIOD_NS, TOLERANCE_NS));
+    }
+    ASSERT_FALSE(SensorDecimation::IsSampleDue(nextDueTimestamp, nextDueTimestamp - TOLERANCE_NS - 1,
+        SAMPLING_PERIOD_NS, TOLERANCE_NS));
+}
+
+/*
+ * Feature: sensor
+ * Function: IsSampleDue
+ * FunctionPoints: Check a subscriber without a sampling period
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: Every sample is due and the schedule is left untouched.
+ */
+HWTEST_F(SensorDecimationTest, SensorDecimationTest_003, TestSize.Level1)
+{
+    int64_t nextDueTimestamp = 0;
+    for (int64_t i = 0; i < 10; i++) {
+        ASSERT_TRUE(SensorDecimation::IsSampleDue(nextDueTimestamp, NS_PER_SECOND + i * INPUT_PERIOD_NS, 0,
+            TOLERANCE_NS));
+    }
+    ASSERT_EQ(nextDueTimestamp, 0);
+}
+}  // namespace Sensors
+}  // namespace OHOS
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <gtest/gtest.h>
+
+#include "securec.h"
+#include "sensor_low_pass_filter.h"
+
+namespace OHOS {
+namespace Sensors {
+using namespace testing::ext;
+
+namespace {
+constexpr int64_t INPUT_PERIOD_NS = 10000000;
+constexpr int64_t OUTPUT_PERIOD_NS = 100000000;
+constexpr double INPUT_RATE_HZ = 100.0;
+constexpr double PI = 3.14159265358979323846;
+constexpr int32_t SETTLE_SAMPLE_COUNT = 200;
+constexpr int32_t MEASURE_SAMPLE_COUNT = 400;
+constexpr float GRAVITY = 9.8f;
+}  // namespace
+
+class SensorLowPassFilterTest : public testing::Test {
+public:
+    static void SetUpTestCase();
+    static void TearDownTestCase();
+    void SetUp();
+    void TearDown();
+};
+
+void SensorLowPassFilterTest::SetUpTestCase()
+{}
+
+void SensorLowPassFilterTest::TearDownTestCase()
+{}
+
+void SensorLowPassFilterTest::SetUp()
+{}
+
+void SensorLowPassFilterTest::TearDown()
+{}
+
+struct TransferSensorEvents MakeEvent(int32_t index, float x, float y, float z)
+{
+    struct TransferSensorEvents event = {};
+    event.timestamp = index * INPUT_PERIOD_NS;
+    float axes[] = { x, y, z };
+    event.dataLen = sizeof(axes);
+    if (memcpy_s(event.data, sizeof(event.data), axes, sizeof(axes)) != EOK) {
+        event.dataLen = 0;
+    }
+    return event;
+}
+
+float GetAxis(const struct TransferSensorEvents &event, size_t axis)
+{
+    float value = 0.0f;
+    if (memcpy_s(&value, sizeof(value), event.data + axis * sizeof(float), sizeof(float)) != EOK) {
+        return NAN;
+    }
+    return value;
+}
+
+// Peak output of a unit sine at frequencyHz on the x axis, measured once the filter has settled
+float MeasureGain(int64_t outputPeriodNs, double frequencyHz)
+{
+    SensorLowPassFilter filter;
+    filter.Configure(INPUT_PERIOD_NS, outputPeriodNs);
+    float peak = 0.0f;
+    for (int32_t i = 0; i < SETTLE_SAMPLE_COUNT + MEASURE_SAMPLE_COUNT; i++) {
+        float value = static_cast<float>(std::sin(2.0 * PI * frequencyHz * i / INPUT_RATE_HZ));
+        filter.Update(MakeEvent(i, value, 0.0f, GRAVITY));
+        if (i >= SETTLE_SAMPLE_COUNT) {
+            peak = std::max(peak, std::fabs(GetAxis(filter.GetOutput(), 0)));
+        }
+    }
+    return peak;
+}
+
+/*
+ * Feature: sensor
+ * Function: SensorLowPassFilter
+ * FunctionPoints: Check the attenuation above the delivered Nyquist frequency
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: 100 Hz input downsampled to 10 Hz, a 40 Hz vibration must be suppressed below 5 percent.
+ */
+HWTEST_F(SensorLowPassFilterTest, SensorLowPassFilterTest_001, TestSize.Level1)
+{
+    ASSERT_LT(MeasureGain(OUTPUT_PERIOD_NS, 40.0), 0.05f);
+}
+
+/*
+ * Feature: sensor
+ * Function: SensorLowPassFilter
+ * FunctionPoints: Check the pass band
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: 100 Hz input downsampled to 10 Hz, a 1 Hz motion keeps at least 90 percent of its amplitude.
+ */
+HWTEST_F(SensorLowPassFilterTest, SensorLowPassFilterTest_002, TestSize.Level1)
+{
+    ASSERT_GT(MeasureGain(OUTPUT_PERIOD_NS, 1.0), 0.9f);
+}
+
+/*
+ * Feature: sensor
+ * Function: SensorLowPassFilter
+ * FunctionPoints: Check the steady state start
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: A constant input is delivered unchanged from the first sample on, with no ramp from zero.
+ */
+HWTEST_F(SensorLowPassFilterTest, SensorLowPassFilterTest_003, TestSize.Level1)
+{
+    SensorLowPassFilter filter;
+    filter.Configure(INPUT_PERIOD_NS, OUTPUT_PERIOD_NS);
+    for (int32_t i = 0; i < SETTLE_SAMPLE_COUNT; i++) {
+        filter.Update(MakeEvent(i, 0.5f, -0.25f, GRAVITY));
+        const struct TransferSensorEvents &output = filter.GetOutput();
+        ASSERT_EQ(output.timestamp, i * INPUT_PERIOD_NS);
+        ASSERT_NEAR(GetAxis(output, 0), 0.5f, 1e-4f);
+        ASSERT_NEAR(GetAxis(output, 1), -0.25f, 1e-4f);
+        ASSERT_NEAR(GetAxis(output, 2), GRAVITY, 1e-3f);
+    }
+}
+
+/*
+ * Feature: sensor
+ * Function: SensorLowPassFilter
+ * FunctionPoints: Check that a subscriber at the input rate is not filtered
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: Without downsampling a 40 Hz signal passes through unchanged.
+ */
+HWTEST_F(SensorLowPassFilterTest, SensorLowPassFilterTest_004, TestSize.Level1)
+{
+    SensorLowPassFilter filter;
+    filter.Configure(INPUT_PERIOD_NS, INPUT_PERIOD_NS);
+    for (int32_t i = 0; i < SETTLE_SAMPLE_COUNT; i++) {
+        float value = static_cast<float>(std::sin(2.0 * PI * 40.0 * i / INPUT_RATE_HZ));
+        filter.Update(MakeEvent(i, value, 0.0f, GRAVITY));
+        ASSERT_FLOAT_EQ(GetAxis(filter.GetOutput(), 0), value);
+    }
+}
+
+/*
+ * Feature: sensor
+ * Function: SensorLowPassFilter
+ * FunctionPoints: Check payloads that are not float axes
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: A payload whose length is not a multiple of a float, or that is empty, is delivered untouched,
+ *                  and a change in the number of axes restarts the filter from the new sample.
+ */
+HWTEST_F(SensorLowPassFilterTest, SensorLowPassFilterTest_005, TestSize.Level1)
+{
+    SensorLowPassFilter filter;
+    filter.Configure(INPUT_PERIOD_NS, OUTPUT_PERIOD_NS);
+    struct TransferSensorEvents event = MakeEvent(0, 1.0f, 2.0f, 3.0f);
+    event.dataLen = sizeof(float) + 1;
+    filter.Update(event);
+    ASSERT_EQ(filter.GetOutput().dataLen, event.dataLen);
+    ASSERT_EQ(memcmp(filter.GetOutput().data, event.data, event.dataLen), 0);
+    event.dataLen = 0;
+    filter.Update(event);
+    ASSERT_EQ(filter.GetOutput().dataLen, 0U);
+
+    filter.Update(MakeEvent(1, 1.0f, 2.0f, 3.0f));
+    for (int32_t i = 2; i < SETTLE_SAMPLE_COUNT; i++) {
+        filter.Update(MakeEvent(i, 1.0f, 2.0f, 3.0f));
+    }
+    struct TransferSensorEvents single = MakeEvent(SETTLE_SAMPLE_COUNT, -5.0f, 0.0f, 0.0f);
+    single.dataLen = sizeof(float);
+    filter.Update(single);
+    ASSERT_EQ(filter.GetOutput().dataLen, sizeof(float));
+    ASSERT_NEAR(GetAxis(filter.GetOutput(), 0), -5.0f, 1e-4f);
+}
+
+/*
+ * Feature: sensor
+ * Function: SensorLowPassFilter
+ * FunctionPoints: Check the step response at the strongest downsampling
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: 100 Hz input delivered at 1 Hz, a step of the input stays finite, overshoots by less than
+ *                  5 percent and settles on the new level.
+ */
+HWTEST_F(SensorLowPassFilterTest, SensorLowPassFilterTest_006, TestSize.Level1)
+{
+    SensorLowPassFilter filter;
+    filter.Configure(INPUT_PERIOD_NS, 100 * INPUT_PERIOD_NS);
+    filter.Update(MakeEvent(0, 0.0f, 0.0f, 0.0f));
+    float peak = 0.0f;
+    int32_t stepSampleCount = 10 * SETTLE_SAMPLE_COUNT;
+    for (int32_t i = 1; i <= stepSampleCount; i++) {
+        filter.Update(MakeEvent(i, GRAVITY, 0.0f, 0.0f));
+        float value = GetAxis(filter.GetOutput(), 0);
+        ASSERT_TRUE(std::isfinite(value));
+        peak = std::max(peak, value);
+    }
+    ASSERT_LT(peak, GRAVITY * 1.05f);
+    // Float coefficients at such a low cutoff leave a DC gain error of about 1e-4
+    ASSERT_NEAR(GetAxis(filter.GetOutput(), 0), GRAVITY, GRAVITY * 1e-3f);
+}
+
+/*
+ * Feature: sensor
+ * Function: Configure
+ * FunctionPoints: Check a change of the subscriber rate
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: Reconfiguring to another rate drops the state of the old one, the next output starts from the
+ *                  current input instead of the history filtered for the old rate.
+ */
+HWTEST_F(SensorLowPassFilterTest, SensorLowPassFilterTest_007, TestSize.Level1)
+{
+    SensorLowPassFilter filter;
+    filter.Configure(INPUT_PERIOD_NS, OUTPUT_PERIOD_NS);
+    for (int32_t i = 0; i < SETTLE_SAMPLE_COUNT; i++) {
+        filter.Update(MakeEvent(i, 0.0f, 0.0f, 0.0f));
+    }
+    filter.Configure(INPUT_PERIOD_NS, 2 * OUTPUT_PERIOD_NS);
+    filter.Update(MakeEvent(SETTLE_SAMPLE_COUNT, GRAVITY, 0.0f, 0.0f));
+    ASSERT_NEAR(GetAxis(filter.GetOutput(), 0), GRAVITY, 1e-3f);
+
+    // The same configuration again keeps the state
+    filter.Configure(INPUT_PERIOD_NS, 2 * OUTPUT_PERIOD_NS);
+    filter.Update(MakeEvent(SETTLE_SAMPLE_COUNT + 1, 0.0f, 0.0f, 0.0f));
+    ASSERT_GT(GetAxis(filter.GetOutput(), 0), GRAVITY / 2);
+}
+}  // namespace Sensors
+}  // namespace OHOS
@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <thread>
+#include <gtest/gtest.h>
+
+#include "accesstoken_kit.h"
+
+#include "client_info.h"
+#include "permission_util.h"
+#include "sensor_agent_type.h"
+
+namespace OHOS {
+namespace Security {
+namespace AccessToken {
+namespace {
+std::atomic<int> g_permissionState { PERMISSION_GRANTED };
+std::atomic<int> g_verifyCount { 0 };
+}  // namespace
+
+// Stands in for the access token service, the tests grant and revoke through g_permissionState
+int AccessTokenKit::VerifyAccessToken(AccessTokenID tokenID, const std::string &permissionName)
+{
+    g_verifyCount++;
+    return g_permissionState.load();
+}
+}  // namespace AccessToken
+}  // namespace Security
+
+namespace Sensors {
+using namespace testing::ext;
+using Security::AccessToken::g_permissionState;
+using Security::AccessToken::g_verifyCount;
+using Security::AccessToken::PERMISSION_DENIED;
+using Security::AccessToken::PERMISSION_GRANTED;
+
+namespace {
+constexpr int32_t TEST_PID = 1000;
+constexpr int32_t TEST_UID = 20010001;
+constexpr AccessTokenID TEST_TOKEN = 0x28000001;
+constexpr AccessTokenID OTHER_TOKEN = 0x28000002;
+constexpr int64_t TEST_SAMPLING_PERIOD_NS = 10000000;
+}  // namespace
+
+class SensorPermissionTest : public testing::Test {
+public:
+    static void SetUpTestCase();
+    static void TearDownTestCase();
+    void SetUp();
+    void TearDown();
+};
+
+void SensorPermissionTest::SetUpTestCase()
+{}
+
+void SensorPermissionTest::TearDownTestCase()
+{}
+
+void SensorPermissionTest::SetUp()
+{
+    g_permissionState.store(PERMISSION_GRANTED);
+}
+
+void SensorPermissionTest::TearDown()
+{
+    PermissionUtil::GetInstance().SetPermissionChangedCallback(nullptr);
+    PermissionUtil::GetInstance().ClearPermissionCache(TEST_TOKEN);
+    PermissionUtil::GetInstance().ClearPermissionCache(OTHER_TOKEN);
+}
+
+// Denied subscribers are not in the dispatch table at all
+bool IsDeliveryAllowed(const ClientInfo &clientInfo, uint32_t sensorId)
+{
+    auto dispatchTable = clientInfo.GetDispatchTable();
+    auto subscribersIt = dispatchTable->subscribers.find(sensorId);
+    return subscribersIt != dispatchTable->subscribers.end() && !subscribersIt->second.empty();
+}
+
+void Subscribe(ClientInfo &clientInfo, uint32_t sensorId)
+{
+    sptr<SensorBasicDataChannel> channel = new (std::nothrow) SensorBasicDataChannel();
+    ASSERT_NE(channel, nullptr);
+    ASSERT_TRUE(clientInfo.UpdateAppThreadInfo(TEST_PID, TEST_UID, TEST_TOKEN));
+    ASSERT_TRUE(clientInfo.UpdateSensorChannel(TEST_PID, channel));
+    SensorBasicInfo sensorInfo;
+    sensorInfo.SetSamplingPeriodNs(TEST_SAMPLING_PERIOD_NS);
+    sensorInfo.SetMaxReportDelayNs(0);
+    sensorInfo.SetSensorState(true);
+    ASSERT_TRUE(clientInfo.UpdateSensorInfo(sensorId, TEST_PID, sensorInfo));
+}
+
+/*
+ * Feature: sensor
+ * Function: RefreshPermissionCache
+ * FunctionPoints: Check that a revoke stops an open stream
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: Revoke the permission of a subscribed client without any further call from it, the next
+ *                  refresh must rebuild the dispatch table with delivery denied.
+ */
+HWTEST_F(SensorPermissionTest, SensorPermissionTest_001, TestSize.Level1)
+{
+    ClientInfo clientInfo;
+    PermissionUtil &permissionUtil = PermissionUtil::GetInstance();
+    std::atomic<int32_t> changedCount { 0 };
+    permissionUtil.SetPermissionChangedCallback([&clientInfo, &changedCount](AccessTokenID callerToken,
+        int32_t sensorTypeId, bool granted) {
+        changedCount++;
+        clientInfo.OnPermissionChanged(callerToken, sensorTypeId, granted);
+    });
+    uint32_t sensorId = SENSOR_TYPE_ID_ACCELEROMETER;
+    ASSERT_TRUE(permissionUtil.CheckSensorPermission(TEST_TOKEN, static_cast<int32_t>(sensorId)));
+    Subscribe(clientInfo, sensorId);
+    ASSERT_TRUE(IsDeliveryAllowed(clientInfo, sensorId));
+
+    g_permissionState.store(PERMISSION_DENIED);
+    ASSERT_TRUE(IsDeliveryAllowed(clientInfo, sensorId));
+    permissionUtil.RefreshPermissionCache();
+    ASSERT_EQ(changedCount.load(), 1);
+    ASSERT_FALSE(IsDeliveryAllowed(clientInfo, sensorId));
+
+    g_permissionState.store(PERMISSION_GRANTED);
+    permissionUtil.RefreshPermissionCache();
+    ASSERT_EQ(changedCount.load(), 2);
+    ASSERT_TRUE(IsDeliveryAllowed(clientInfo, sensorId));
+}
+
+/*
+ * Feature: sensor
+ * Function: RefreshPermissionCache
+ * FunctionPoints: Check that an unchanged permission does not rebuild the dispatch table
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: Refresh without any change in the access token state, no callback may fire.
+ */
+HWTEST_F(SensorPermissionTest, SensorPermissionTest_002, TestSize.Level1)
+{
+    PermissionUtil &permissionUtil = PermissionUtil::GetInstance();
+    std::atomic<int32_t> changedCount { 0 };
+    permissionUtil.SetPermissionChangedCallback([&changedCount](AccessTokenID callerToken, int32_t sensorTypeId,
+        bool granted) {
+        changedCount++;
+    });
+    ASSERT_TRUE(permissionUtil.CheckSensorPermission(TEST_TOKEN, SENSOR_TYPE_ID_GYROSCOPE));
+    permissionUtil.RefreshPermissionCache();
+    ASSERT_EQ(changedCount.load(), 0);
+    bool granted = false;
+    ASSERT_TRUE(permissionUtil.PeekSensorPermission(TEST_TOKEN, SENSOR_TYPE_ID_GYROSCOPE, granted));
+    ASSERT_TRUE(granted);
+}
+
+/*
+ * Feature: sensor
+ * Function: PublishDispatchTable
+ * FunctionPoints: Check a subscriber whose permission is not cached yet
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: Publish with an empty cache, the permission is verified once and a denied subscriber never
+ *                  enters the dispatch table.
+ */
+HWTEST_F(SensorPermissionTest, SensorPermissionTest_003, TestSize.Level1)
+{
+    ClientInfo clientInfo;
+    PermissionUtil &permissionUtil = PermissionUtil::GetInstance();
+    uint32_t sensorId = SENSOR_TYPE_ID_HEART_RATE;
+    bool granted = true;
+    g_permissionState.store(PERMISSION_DENIED);
+    ASSERT_FALSE(permissionUtil.PeekSensorPermission(TEST_TOKEN, static_cast<int32_t>(sensorId), granted));
+    Subscribe(clientInfo, sensorId);
+    ASSERT_FALSE(IsDeliveryAllowed(clientInfo, sensorId));
+    ASSERT_TRUE(permissionUtil.PeekSensorPermission(TEST_TOKEN, static_cast<int32_t>(sensorId), granted));
+    ASSERT_FALSE(granted);
+
+    // Sensors without a permission are delivered whatever the token holds
+    Subscribe(clientInfo, SENSOR_TYPE_ID_AMBIENT_LIGHT);
+    ASSERT_TRUE(IsDeliveryAllowed(clientInfo, SENSOR_TYPE_ID_AMBIENT_LIGHT));
+}
+
+/*
+ * Feature: sensor
+ * Function: RenewSensorPermission
+ * FunctionPoints: Check that a stale grant is verified again on the data path
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: Revoke after the grant was cached, the data path keeps the grant while it is fresh and asks the
+ *                  access token kit as soon as it is stale, without waiting for the monitor.
+ */
+HWTEST_F(SensorPermissionTest, SensorPermissionTest_004, TestSize.Level1)
+{
+    PermissionUtil &permissionUtil = PermissionUtil::GetInstance();
+    std::atomic<int32_t> changedCount { 0 };
+    permissionUtil.SetPermissionChangedCallback([&changedCount](AccessTokenID callerToken, int32_t sensorTypeId,
+        bool granted) {
+        changedCount++;
+    });
+    int64_t grantExpiry = 0;
+    ASSERT_TRUE(permissionUtil.RenewSensorPermission(TEST_TOKEN, SENSOR_TYPE_ID_ACCELEROMETER, grantExpiry));
+    ASSERT_GT(grantExpiry, 0);
+
+    g_permissionState.store(PERMISSION_DENIED);
+    int32_t verifyCount = g_verifyCount.load();
+    ASSERT_TRUE(permissionUtil.RenewSensorPermission(TEST_TOKEN, SENSOR_TYPE_ID_ACCELEROMETER, grantExpiry));
+    ASSERT_EQ(g_verifyCount.load(), verifyCount);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    ASSERT_FALSE(permissionUtil.RenewSensorPermission(TEST_TOKEN, SENSOR_TYPE_ID_ACCELEROMETER, grantExpiry));
+    ASSERT_EQ(grantExpiry, 0);
+    ASSERT_EQ(changedCount.load(), 1);
+    // Denials are never cached on the data path, every event asks again until the table drops the subscriber
+    ASSERT_FALSE(permissionUtil.RenewSensorPermission(TEST_TOKEN, SENSOR_TYPE_ID_ACCELEROMETER, grantExpiry));
+    ASSERT_EQ(changedCount.load(), 1);
+
+    // Sensors without a permission never expire
+    ASSERT_TRUE(permissionUtil.RenewSensorPermission(TEST_TOKEN, SENSOR_TYPE_ID_AMBIENT_LIGHT, grantExpiry));
+    ASSERT_EQ(grantExpiry, std::numeric_limits<int64_t>::max());
+}
+
+/*
+ * Feature: sensor
+ * Function: StartPermissionMonitor
+ * FunctionPoints: Check that the monitor only runs while there is something to re-verify
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: Start the monitor with an empty cache, it must not run until a permission is cached and must
+ *                  stop by itself once the cache is emptied again.
+ */
+HWTEST_F(SensorPermissionTest, SensorPermissionTest_005, TestSize.Level1)
+{
+    PermissionUtil &permissionUtil = PermissionUtil::GetInstance();
+    permissionUtil.StartPermissionMonitor();
+    ASSERT_FALSE(permissionUtil.IsPermissionMonitorRunning());
+    ASSERT_TRUE(permissionUtil.CheckSensorPermission(TEST_TOKEN, SENSOR_TYPE_ID_GYROSCOPE));
+    ASSERT_TRUE(permissionUtil.IsPermissionMonitorRunning());
+
+    permissionUtil.ClearPermissionCache(TEST_TOKEN);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+    ASSERT_FALSE(permissionUtil.IsPermissionMonitorRunning());
+
+    // A new entry wakes the monitor again, stopping it joins whatever run is in flight
+    ASSERT_TRUE(permissionUtil.CheckSensorPermission(TEST_TOKEN, SENSOR_TYPE_ID_GYROSCOPE));
+    ASSERT_TRUE(permissionUtil.IsPermissionMonitorRunning());
+    permissionUtil.StopPermissionMonitor();
+    ASSERT_FALSE(permissionUtil.IsPermissionMonitorRunning());
+}
+
+/*
+ * Feature: sensor
+ * Function: RefreshPermissionCache
+ * FunctionPoints: Check the refresh of a single access token
+ * EnvConditions: mobile that can run ohos test framework
+ * CaseDescription: Refresh the permissions of one token on its control path, entries of other tokens must be
+ *                  left to the monitor.
+ */
+HWTEST_F(SensorPermissionTest, SensorPermissionTest_006, TestSize.Level1)
+{
+    PermissionUtil &permissionUtil = PermissionUtil::GetInstance();
+    std::atomic<int32_t> changedCount { 0 };
+    permissionUtil.SetPermissionChangedCallback([&changedCount](AccessTokenID callerToken, int32_t sensorTypeId,
+        bool granted) {
+        ASSERT_EQ(callerToken, TEST_TOKEN);
+        changedCount++;
+    });
+    ASSERT_TRUE(permissionUtil.CheckSensorPermission(TEST_TOKEN, SENSOR_TYPE_ID_ACCELEROMETER));
+    ASSERT_TRUE(permissionUtil.CheckSensorPermission(OTHER_TOKEN, SENSOR_TYPE_ID_ACCELEROMETER));
+
+    g_permissionState.store(PERMISSION_DENIED);
+    int32_t verifyCount = g_verifyCount.load();
+    permissionUtil.RefreshPermissionCache(TEST_TOKEN);
+    ASSERT_EQ(g_verifyCount.load(), verifyCount + 1);
+    ASSERT_EQ(changedCount.load(), 1);
+    bool granted = false;
+    ASSERT_TRUE(permissionUtil.PeekSensorPermission(OTHER_TOKEN, SENSOR_TYPE_ID_ACCELEROMETER, granted));
+    ASSERT_TRUE(granted);
+}
+}  // namespace Sensors
+}  // namespace OHOS
@@ -0,0 +1,419 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cmath>
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "securec.h"
+#include "sensor_wire_format.h"
+
+namespace OHOS {
+namespace Sensors {
+using namespace testing::ext;
+
+namespace {
+constexpr uint32_t ACCELEROMETER_ID = 1;
+constexpr uint32_t AMBIENT_LIGHT_ID = 5;
+constexpr int64_t INPUT_PERIOD_NS = 10000000;
+constexpr size_t MAX_EVENT_COUNT = 100;
+constexpr size_t RECORD_ALIGN = sizeof(int64_t);
+constexpr size_t AXIS_COUNT = 3;
+constexpr size_t DELTA_EVENT_COUNT = 50;
+constexpr float QUANTUM = 0.001f;
+// Float rounding of base + quantum * level on values around gravity, on top of the half quantum
+constexpr float FLOAT_TOLERANCE = 0.00001f;
+constexpr float GRAVITY = 9.8f;
+}  // namespace
+
+class SensorWireFormatTest : public testing::Test {
+public:
+    static void SetUpTestCase();
+    static void TearDownTestCase();
+    void SetUp();
+    void TearDown();
+};
+
+void SensorWireFormatTest::SetUpTestCase()
+{}
+
+void SensorWireFormatTest::TearDownTestCase()
+{}
+
+void SensorWireFormatTest::SetUp()
+{}
+
+void SensorWireFormatTest::TearDown()
+{}
+
+struct TransferSensorEvents MakeEvent(uint32_t sensorTypeId, int64_t timestamp, const std::vector<float> &axes)
+{
+    struct TransferSensorEvents event = {};
+    event.sensorTypeId = sensorTypeId;
+    event.version = 1;
+    event.timestamp = timestamp;
+    event.mode = 1;
+    event.dataLen = axes.size() * sizeof(float);
+    if (memcpy_s(event.data, sizeof(event.data), axes.data(), event.dataLen) != EOK) {
+        event.dataLen = 0;
+    }
+    return event;
+}
+
+float GetAxis(const struct TransferSensorEvents &event, size_t axis)
+{
+    float value = 0.0f;
+    if (memcpy_s(&value, sizeof(value), event.data + axis * sizeof(float), sizeof(float)) != EOK) {
+        return NAN;
+    }
+    return value;
+}
+
+// A slowly drifting accelerometer stream, every axis moves by less than a quantum step range per event
+std::vector<struct TransferSensorEvents> MakeDeltaStream(size_t count)
+{
+    std::vector<struct TransferSensorEvents> events;
+    for (size_t i = 0; i < count; i++) {
+        float phase = static_cast<float>(i) * 0.1f;
+        events.push_back(MakeEvent(ACCELEROMETER_ID, static_cast<int64_t>(i + 1) * INPUT_PERIOD_NS + (i % 2),
+            { 0.3f * std::sin(phase), -0.2f * std::cos(phase), GRAVITY + 0.05f * std::sin(2 * phase) }));
+    }
+    return events;
+}
+
+size_t GetAlignedSize(size_t size)
+{
+    return (size + RECORD_ALIGN - 1) / RECORD_ALIGN * RECORD_ALIGN;
+}
+
+void ExpectSameHeader(const struct TransferSensorEvents &expected, const struct TransferSensorEvents &actual)
+{
+    EXPECT_EQ(actual.sensorTypeId, expected.sensorTypeId);
+    EXPECT_EQ(actual.version, expected.version);
+    EXPECT_EQ(actual.timestamp, expected.timestamp);
+    EXPECT_EQ(actual.option, expected.option);
+    EXPECT_EQ(actual.mode, expected.mode);
+    EXPECT_EQ(actual.dataLen, expected.dataLen);
+}
+
+/*
+ * @tc.name: SensorWireFormatTest_001
+ * @tc.desc: a compact record carries exactly dataLen payload bytes, zero padded, and decodes back bit for bit
+ * @tc.type: FUNC
+ */
+HWTEST_F(SensorWireFormatTest, SensorWireFormatTest_001, TestSize.Level1)
+{
+    struct TransferSensorEvents event = MakeEvent(AMBIENT_LIGHT_ID, INPUT_PERIOD_NS, { 321.5f });
+    size_t recordSize = SensorWireFormat::GetCompactEventSize(event);
+    size_t length = sizeof(CompactEventHeader) + event.dataLen;
+    ASSERT_EQ(recordSize % RECORD_ALIGN, 0U);
+    ASSERT_GE(recordSize, length);
+    ASSERT_LT(recordSize, length + RECORD_ALIGN);
+    ASSERT_LT(recordSize, sizeof(struct TransferSensorEvents));
+    std::vector<uint8_t> buffer(recordSize, 0xff);
+    ASSERT_EQ(SensorWireFormat::EncodeCompactEvent(event, buffer.data(), buffer.size()), recordSize);
+    for (size_t i = length; i < recordSize; i++) {
+        EXPECT_EQ(buffer[i], 0U);
+    }
+    struct TransferSensorEvents decoded[MAX_EVENT_COUNT];
+    ASSERT_EQ(SensorWireFormat::DecodeCompactEvents(buffer.data(), buffer.size(), decoded, MAX_EVENT_COUNT), 1U);
+    ExpectSameHeader(event, decoded[0]);
+    EXPECT_EQ(memcmp(decoded[0].data, event.data, event.dataLen), 0);
+}
+
+/*
+ * @tc.name: SensorWireFormatTest_002
+ * @tc.desc: records of different sizes packed into one datagram decode in order
+ * @tc.type: FUNC
+ */
+HWTEST_F(SensorWireFormatTest, SensorWireFormatTest_002, TestSize.Level1)
+{
+    std::vector<struct TransferSensorEvents> events = {
+        MakeEvent(ACCELEROMETER_ID, INPUT_PERIOD_NS, { 0.1f, -0.2f, 9.8f }),
+        MakeEvent(AMBIENT_LIGHT_ID, 2 * INPUT_PERIOD_NS, { 100.0f }),
+        MakeEvent(ACCELEROMETER_ID, 3 * INPUT_PERIOD_NS, { 0.3f, -0.4f, 9.7f }),
+        MakeEvent(AMBIENT_LIGHT_ID, 4 * INPUT_PERIOD_NS, {}),
+    };
+    std::vector<uint8_t> buffer(events.size() * sizeof(struct TransferSensorEvents));
+    size_t length = 0;
+    for (const auto &event : events) {
+        size_t recordSize = SensorWireFormat::EncodeCompactEvent(event, buffer.data() + length,
+            buffer.size() - length);
+        ASSERT_EQ(recordSize, SensorWireFormat::GetCompactEventSize(event));
+        length += recordSize;
+    }
+    struct TransferSensorEvents decoded[MAX_EVENT_COUNT];
+    ASSERT_EQ(SensorWireFormat::DecodeCompactEvents(buffer.data(), length, decoded, MAX_EVENT_COUNT), events.size());
+    for (size_t i = 0; i < events.size(); i++) {
+        ExpectSameHeader(events[i], decoded[i]);
+        EXPECT_EQ(memcmp(decoded[i].data, events[i].data, events[i].dataLen), 0);
+    }
+}
+
+/*
+ * @tc.name: SensorWireFormatTest_003
+ * @tc.desc: encoding into a short buffer fails, a truncated datagram yields only its complete records
+ * @tc.type: FUNC
+ */
+HWTEST_F(SensorWireFormatTest, SensorWireFormatTest_003, TestSize.Level1)
+{
+    struct TransferSensorEvents event = MakeEvent(ACCELEROMETER_ID, INPUT_PERIOD_NS, { 0.1f, -0.2f, 9.8f });
+    size_t recordSize = SensorWireFormat::GetCompactEventSize(event);
+    std::vector<uint8_t> buffer(2 * recordSize);
+    ASSERT_EQ(SensorWireFormat::EncodeCompactEvent(event, buffer.data(), recordSize - 1), 0U);
+    ASSERT_EQ(SensorWireFormat::EncodeCompactEvent(event, buffer.data(), buffer.size()), recordSize);
+    ASSERT_EQ(SensorWireFormat::EncodeCompactEvent(event, buffer.data() + recordSize, recordSize), recordSize);
+    struct TransferSensorEvents decoded[MAX_EVENT_COUNT];
+    EXPECT_EQ(SensorWireFormat::DecodeCompactEvents(buffer.data(), buffer.size() - 1, decoded, MAX_EVENT_COUNT), 1U);
+    EXPECT_EQ(SensorWireFormat::DecodeCompactEvents(buffer.data(), recordSize - 1, decoded, MAX_EVENT_COUNT), 0U);
+    EXPECT_EQ(SensorWireFormat::DecodeCompactEvents(buffer.data(), buffer.size(), decoded, 1), 1U);
+    EXPECT_FLOAT_EQ(GetAxis(decoded[0], 2), 9.8f);
+}
+
+/*
+ * @tc.name: SensorWireFormatTest_004
+ * @tc.desc: a delta block keeps the keyframe exact and every other axis within half a quantum
+ * @tc.type: FUNC
+ */
+HWTEST_F(SensorWireFormatTest, SensorWireFormatTest_004, TestSize.Level1)
+{
+    std::vector<struct TransferSensorEvents> events = MakeDeltaStream(DELTA_EVENT_COUNT);
+    std::vector<uint8_t> buffer(events.size() * sizeof(struct TransferSensorEvents));
+    size_t encodedCount = 0;
+    size_t recordSize = SensorWireFormat::EncodeDeltaBlock(events.data(), events.size(), QUANTUM, buffer.data(),
+        buffer.size(), encodedCount);
+    ASSERT_EQ(encodedCount, events.size());
+    ASSERT_GT(recordSize, 0U);
+    ASSERT_EQ(recordSize % RECORD_ALIGN, 0U);
+    ASSERT_LT(recordSize, events.size() * SensorWireFormat::GetCompactEventSize(events[0]));
+    struct TransferSensorEvents decoded[MAX_EVENT_COUNT];
+    ASSERT_EQ(SensorWireFormat::DecodeCompactEvents(buffer.data(), recordSize, decoded, MAX_EVENT_COUNT),
+        events.size());
+    EXPECT_EQ(memcmp(decoded[0].data, events[0].data, events[0].dataLen), 0);
+    for (size_t i = 0; i < events.size(); i++) {
+        ExpectSameHeader(events[i], decoded[i]);
+        for (size_t axis = 0; axis < AXIS_COUNT; axis++) {
+            EXPECT_NEAR(GetAxis(decoded[i], axis), GetAxis(events[i], axis), QUANTUM / 2 + FLOAT_TOLERANCE);
+        }
+    }
+}
+
+/*
+ * @tc.name: SensorWireFormatTest_005
+ * @tc.desc: a block ends before a step that overflows int16 or an event of another stream
+ * @tc.type: FUNC
+ */
+HWTEST_F(SensorWireFormatTest, SensorWireFormatTest_005, TestSize.Level1)
+{
+    constexpr size_t breakIndex = 10;
+    std::vector<struct TransferSensorEvents> events = MakeDeltaStream(DELTA_EVENT_COUNT);
+    // 100 over a 0.001 quantum is 100000 steps, beyond what an int16 step holds
+    events[breakIndex] = MakeEvent(ACCELEROMETER_ID, events[breakIndex].timestamp, { 100.0f, 0.0f, GRAVITY });
+    std::vector<uint8_t> buffer(events.size() * sizeof(struct TransferSensorEvents));
+    size_t encodedCount = 0;
+    size_t recordSize = SensorWireFormat::EncodeDeltaBlock(events.data(), events.size(), QUANTUM, buffer.data(),
+        buffer.size(), encodedCount);
+    ASSERT_GT(recordSize, 0U);
+    ASSERT_EQ(encodedCount, breakIndex);
+    struct TransferSensorEvents decoded[MAX_EVENT_COUNT];
+    ASSERT_EQ(SensorWireFormat::DecodeCompactEvents(buffer.data(), recordSize, decoded, MAX_EVENT_COUNT),
+        breakIndex);
+    EXPECT_EQ(decoded[breakIndex - 1].timestamp, events[breakIndex - 1].timestamp);
+
+    events = MakeDeltaStream(DELTA_EVENT_COUNT);
+    events[breakIndex].sensorTypeId = AMBIENT_LIGHT_ID;
+    SensorWireFormat::EncodeDeltaBlock(events.data(), events.size(), QUANTUM, buffer.data(), buffer.size(),
+        encodedCount);
+    EXPECT_EQ(encodedCount, breakIndex);
+}
+
+/*
+ * @tc.name: SensorWireFormatTest_006
+ * @tc.desc: nothing is encoded without a delta to carry, a valid quantum or float axes
+ * @tc.type: FUNC
+ */
+HWTEST_F(SensorWireFormatTest, SensorWireFormatTest_006, TestSize.Level1)
+{
+    std::vector<struct TransferSensorEvents> events = MakeDeltaStream(DELTA_EVENT_COUNT);
+    std::vector<uint8_t> buffer(events.size() * sizeof(struct TransferSensorEvents));
+    size_t encodedCount = 0;
+    EXPECT_EQ(SensorWireFormat::EncodeDeltaBlock(events.data(), 1, QUANTUM, buffer.data(), buffer.size(),
+        encodedCount), 0U);
+    EXPECT_EQ(SensorWireFormat::EncodeDeltaBlock(events.data(), events.size(), 0.0f, buffer.data(), buffer.size(),
+        encodedCount), 0U);
+    EXPECT_EQ(SensorWireFormat::EncodeDeltaBlock(events.data(), events.size(), NAN, buffer.data(), buffer.size(),
+        encodedCount), 0U);
+    events[0].dataLen = 0;
+    EXPECT_EQ(SensorWireFormat::EncodeDeltaBlock(events.data(), events.size(), QUANTUM, buffer.data(),
+        buffer.size(), encodedCount), 0U);
+    EXPECT_EQ(encodedCount, 0U);
+}
+
+/*
+ * @tc.name: SensorWireFormatTest_007
+ * @tc.desc: decoding stops at a corrupt record and keeps the records before it
+ * @tc.type: FUNC
+ */
+HWTEST_F(SensorWireFormatTest, SensorWireFormatTest_007, TestSize.Level1)
+{
+    struct TransferSensorEvents event = MakeEvent(ACCELEROMETER_ID, INPUT_PERIOD_NS, { 0.1f, -0.2f, 9.8f });
+    size_t recordSize = SensorWireFormat::GetCompactEventSize(event);
+    std::vector<uint8_t> buffer(2 * recordSize);
+    struct TransferSensorEvents decoded[MAX_EVENT_COUNT];
+    auto corruptSecondHeader = [&buffer, &event, recordSize](uint32_t encoding, uint32_t dataLen) {
+        ASSERT_EQ(SensorWireFormat::EncodeCompactEvent(event, buffer.data(), buffer.size()), recordSize);
+        ASSERT_EQ(SensorWireFormat::EncodeCompactEvent(event, buffer.data() + recordSize, recordSize), recordSize);
+        CompactEventHeader header;
+        ASSERT_EQ(memcpy_s(&header, sizeof(header), buffer.data() + recordSize, sizeof(header)), EOK);
+        header.encoding = encoding;
+        header.dataLen = dataLen;
+        ASSERT_EQ(memcpy_s(buffer.data() + recordSize, recordSize, &header, sizeof(header)), EOK);
+    };
+    corruptSecondHeader(COMPACT_ENCODING_DELTA + 1, event.dataLen);
+    EXPECT_EQ(SensorWireFormat::DecodeCompactEvents(buffer.data(), buffer.size(), decoded, MAX_EVENT_COUNT), 1U);
+    corruptSecondHeader(COMPACT_ENCODING_RAW, SENSOR_MAX_LENGTH + sizeof(float));
+    EXPECT_EQ(SensorWireFormat::DecodeCompactEvents(buffer.data(), buffer.size(), decoded, MAX_EVENT_COUNT), 1U);
+    // A payload that would run past the end of the datagram
+    corruptSecondHeader(COMPACT_ENCODING_RAW, recordSize);
+    EXPECT_EQ(SensorWireFormat::DecodeCompactEvents(buffer.data(), buffer.size(), decoded, MAX_EVENT_COUNT), 1U);
+    // A delta record whose keyframe alone does not fit
+    corruptSecondHeader(COMPACT_ENCODING_DELTA, recordSize);
+    EXPECT_EQ(SensorWireFormat::DecodeCompactEvents(buffer.data(), buffer.size(), decoded, MAX_EVENT_COUNT), 1U);
+    ExpectSameHeader(event, decoded[0]);
+}
+
+/*
+ * @tc.name: SensorWireFormatTest_008
+ * @tc.desc: a full size payload round trips, a dataLen beyond the event buffer is clamped on encoding
+ * @tc.type: FUNC
+ */
+HWTEST_F(SensorWireFormatTest, SensorWireFormatTest_008, TestSize.Level1)
+{
+    std::vector<float> axes(SENSOR_MAX_LENGTH / sizeof(float));
+    for (size_t i = 0; i < axes.size(); i++) {
+        axes[i] = static_cast<float>(i) - 0.5f;
+    }
+    struct TransferSensorEvents event = MakeEvent(ACCELEROMETER_ID, INPUT_PERIOD_NS, axes);
+    ASSERT_EQ(event.dataLen, static_cast<uint32_t>(SENSOR_MAX_LENGTH));
+    size_t recordSize = SensorWireFormat::GetCompactEventSize(event);
+    ASSERT_EQ(recordSize, GetAlignedSize(sizeof(CompactEventHeader) + SENSOR_MAX_LENGTH));
+    std::vector<uint8_t> buffer(recordSize);
+    ASSERT_EQ(SensorWireFormat::EncodeCompactEvent(event, buffer.data(), buffer.size()), recordSize);
+    struct TransferSensorEvents decoded[MAX_EVENT_COUNT];
+    ASSERT_EQ(SensorWireFormat::DecodeCompactEvents(buffer.data(), buffer.size(), decoded, MAX_EVENT_COUNT), 1U);
+    EXPECT_EQ(memcmp(decoded[0].data, event.data, SENSOR_MAX_LENGTH), 0);
+
+    event.dataLen = SENSOR_MAX_LENGTH + sizeof(float);
+    ASSERT_EQ(SensorWireFormat::GetCompactEventSize(event), recordSize);
+    ASSERT_EQ(SensorWireFormat::EncodeCompactEvent(event, buffer.data(), buffer.size()), recordSize);
+    ASSERT_EQ(SensorWireFormat::DecodeCompactEvents(buffer.data(), buffer.size(), decoded, MAX_EVENT_COUNT), 1U);
+    EXPECT_EQ(decoded[0].dataLen, static_cast<uint32_t>(SENSOR_MAX_LENGTH));
+}
+
+/*
+ * @tc.name: SensorWireFormatTest_009
+ * @tc.desc: a stream longer than one block is split into back to back blocks that decode to the whole stream
+ * @tc.type: FUNC
+ */
+HWTEST_F(SensorWireFormatTest, SensorWireFormatTest_009, TestSize.Level1)
+{
+    constexpr size_t streamCount = 2 * MAX_EVENT_COUNT + 10;
+    std::vector<struct TransferSensorEvents> events = MakeDeltaStream(streamCount);
+    std::vector<uint8_t> buffer(events.size() * sizeof(struct TransferSensorEvents));
+    size_t length = 0;
+    size_t encodedTotal = 0;
+    size_t blockCount = 0;
+    while (encodedTotal < events.size()) {
+        size_t encodedCount = 0;
+        size_t recordSize = SensorWireFormat::EncodeDeltaBlock(events.data() + encodedTotal,
+            events.size() - encodedTotal, QUANTUM, buffer.data() + length, buffer.size() - length, encodedCount);
+        if (recordSize == 0) {
+            // A lone trailing event has no delta to carry
+            recordSize = SensorWireFormat::EncodeCompactEvent(events[encodedTotal], buffer.data() + length,
+                buffer.size() - length);
+            encodedCount = 1;
+        }
+        ASSERT_GT(recordSize, 0U);
+        ASSERT_LE(encodedCount, MAX_EVENT_COUNT);
+        length += recordSize;
+        encodedTotal += encodedCount;
+        blockCount++;
+    }
+    ASSERT_GE(blockCount, 3U);
+    std::vector<struct TransferSensorEvents> decoded(streamCount);
+    ASSERT_EQ(SensorWireFormat::DecodeCompactEvents(buffer.data(), length, decoded.data(), decoded.size()),
+        streamCount);
+    for (size_t i = 0; i < streamCount; i++) {
+        ExpectSameHeader(events[i], decoded[i]);
+        for (size_t axis = 0; axis < AXIS_COUNT; axis++) {
+            EXPECT_NEAR(GetAxis(decoded[i], axis), GetAxis(events[i], axis), QUANTUM / 2 + FLOAT_TOLERANCE);
+        }
+    }
+}
+
+/*
+ * @tc.name: SensorWireFormatTest_010
+ * @tc.desc: a block ends before a NaN value or a timestamp that goes backwards
+ * @tc.type: FUNC
+ */
+HWTEST_F(SensorWireFormatTest, SensorWireFormatTest_010, TestSize.Level1)
+{
+    constexpr size_t breakIndex = 10;
+    std::vector<struct TransferSensorEvents> events = MakeDeltaStream(DELTA_EVENT_COUNT);
+    events[breakIndex] = MakeEvent(ACCELEROMETER_ID, events[breakIndex].timestamp, { NAN, 0.0f, GRAVITY });
+    std::vector<uint8_t> buffer(events.size() * sizeof(struct TransferSensorEvents));
+    size_t encodedCount = 0;
+    ASSERT_GT(SensorWireFormat::EncodeDeltaBlock(events.data(), events.size(), QUANTUM, buffer.data(),
+        buffer.size(), encodedCount), 0U);
+    EXPECT_EQ(encodedCount, breakIndex);
+
+    events = MakeDeltaStream(DELTA_EVENT_COUNT);
+    events[breakIndex].timestamp = events[breakIndex - 1].timestamp - 1;
+    ASSERT_GT(SensorWireFormat::EncodeDeltaBlock(events.data(), events.size(), QUANTUM, buffer.data(),
+        buffer.size(), encodedCount), 0U);
+    EXPECT_EQ(encodedCount, breakIndex);
+}
+
+/*
+ * @tc.name: SensorWireFormatTest_011
+ * @tc.desc: a delta block is not decoded into less room than it holds, and stops a too short buffer on encoding
+ * @tc.type: FUNC
+ */
+HWTEST_F(SensorWireFormatTest, SensorWireFormatTest_011, TestSize.Level1)
+{
+    std::vector<struct TransferSensorEvents> events = MakeDeltaStream(DELTA_EVENT_COUNT);
+    std::vector<uint8_t> buffer(events.size() * sizeof(struct TransferSensorEvents));
+    size_t encodedCount = 0;
+    size_t recordSize = SensorWireFormat::EncodeDeltaBlock(events.data(), events.size(), QUANTUM, buffer.data(),
+        buffer.size(), encodedCount);
+    ASSERT_EQ(encodedCount, events.size());
+    struct TransferSensorEvents decoded[MAX_EVENT_COUNT];
+    EXPECT_EQ(SensorWireFormat::DecodeCompactEvents(buffer.data(), recordSize, decoded, events.size() - 1), 0U);
+    EXPECT_EQ(SensorWireFormat::DecodeCompactEvents(buffer.data(), recordSize - RECORD_ALIGN, decoded,
+        MAX_EVENT_COUNT), 0U);
+
+    // Only as many deltas as fit are taken, the rest starts the next block
+    size_t shortSize = recordSize / 2;
+    size_t shortRecordSize = SensorWireFormat::EncodeDeltaBlock(events.data(), events.size(), QUANTUM,
+        buffer.data(), shortSize, encodedCount);
+    ASSERT_GT(shortRecordSize, 0U);
+    ASSERT_LE(shortRecordSize, shortSize);
+    ASSERT_GT(encodedCount, 1U);
+    ASSERT_LT(encodedCount, events.size());
+    EXPECT_EQ(SensorWireFormat::DecodeCompactEvents(buffer.data(), shortRecordSize, decoded, MAX_EVENT_COUNT),
+        encodedCount);
+}
+}  // namespace Sensors
+}  // namespace OHOS
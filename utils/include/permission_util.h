@@ -16,7 +16,11 @@
 #ifndef PERMISSION_UTIL_H
 #define PERMISSION_UTIL_H
 
+#include <condition_variable>
+#include <functional>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 
 #include "accesstoken_kit.h"
@@ -28,11 +32,44 @@ using namespace Security::AccessToken;
 class PermissionUtil : public Singleton<PermissionUtil> {
 public:
     PermissionUtil() = default;
-    virtual ~PermissionUtil() {};
+    virtual ~PermissionUtil();
+    using PermissionChangedCallback = std::function<void(AccessTokenID, int32_t, bool)>;
     bool CheckSensorPermission(AccessTokenID callerToken, int32_t sensorTypeId);
+    bool PeekSensorPermission(AccessTokenID callerToken, int32_t sensorTypeId, bool &granted);
+    bool RenewSensorPermission(AccessTokenID callerToken, int32_t sensorTypeId, int64_t &grantExpiry);
+    void ClearPermissionCache(AccessTokenID callerToken);
+    void SetPermissionChangedCallback(PermissionChangedCallback callback);
+    void RefreshPermissionCache();
+    void RefreshPermissionCache(AccessTokenID callerToken);
+    void StartPermissionMonitor();
+    void StopPermissionMonitor();
+    bool IsPermissionMonitorRunning();
 
 private:
+    struct PermissionDecision {
+        bool granted = false;
+        // Referenced by a dispatch table, such entries live until the channel of their client goes away
+        bool isWatched = false;
+        int64_t verifiedTime = 0;
+        int64_t usedTime = 0;
+    };
+    bool VerifySensorPermission(AccessTokenID callerToken, int32_t sensorTypeId);
+    void RefreshPermissions(const AccessTokenID *callerToken);
+    bool IsPermissionCacheEmpty();
+    void WakePermissionMonitor();
+    void RunPermissionMonitor();
     static std::unordered_map<uint32_t, std::string> sensorPermissions_;
+    std::mutex permissionMutex_;
+    // (callerToken, sensorTypeId) -> last decision of the access token kit
+    std::unordered_map<uint64_t, PermissionDecision> permissionCache_;
+    PermissionChangedCallback permissionChangedCallback_;
+    // Re-verifies the cached decisions on a fixed interval so a revoke reaches streams that make no new calls,
+    // the thread only exists while the cache holds anything to re-verify
+    std::mutex monitorMutex_;
+    std::condition_variable monitorCondition_;
+    bool isMonitorEnabled_ = false;
+    bool isMonitorRunning_ = false;
+    std::thread monitorThread_;
 };
 }  // namespace Sensors
 }  // namespace OHOS
@@ -16,31 +16,39 @@
 #ifndef REPORT_DATA_CALLBACK_H
 #define REPORT_DATA_CALLBACK_H
 
+#include <memory>
 #include <vector>
 
 #include "refbase.h"
 
 #include "sensor_agent_type.h"
+#include "sensor_event_ring.h"
 
 namespace OHOS {
 namespace Sensors {
-constexpr int32_t CIRCULAR_BUF_LEN = 1024;
+constexpr uint32_t CIRCULAR_BUF_LEN = 1024;
 constexpr int32_t SENSOR_DATA_LENGHT = 64;
-
-struct CircularEventBuf {
-    struct  SensorEvent *circularBuf;
-    int32_t readPos;
-    int32_t writePosition;
-    int32_t eventNum;
-};
+constexpr uint32_t MAX_EVENT_RING_COUNT = 8;
 
 class ReportDataCallback : public RefBase {
 public:
-    ReportDataCallback();
-    ~ReportDataCallback();
+    explicit ReportDataCallback(uint32_t ringCount = 1);
+    ~ReportDataCallback() = default;
     int32_t ReportEventCallback(const struct SensorEvent *event, sptr<ReportDataCallback> cb);
-    struct CircularEventBuf &GetEventData();
-    struct CircularEventBuf eventsBuf_;
+    /*
+     * Publishes count events with one ring store per ring. Only the compatible HDI hands over a whole FIFO flush,
+     * the V1_0 HDI calls back once per event and every one of them is a batch of one.
+     */
+    int32_t ReportEventsCallback(const struct SensorEvent *events, int32_t count, sptr<ReportDataCallback> cb);
+    uint32_t GetEventRingCount() const;
+    SensorEventRing &GetEventData(uint32_t ringIndex = 0);
+    uint64_t GetDroppedCount() const;
+
+private:
+    uint32_t GetRingIndex(int32_t sensorTypeId) const;
+    uint32_t PushShardedEvents(const struct SensorEvent *events, uint32_t count);
+    // One ring per dispatcher worker, a sensor always maps to the same ring so its events stay in order
+    std::vector<std::unique_ptr<SensorEventRing>> eventsRings_;
 };
 
 using ZReportDataCb = int32_t (ReportDataCallback::*)(const struct SensorEvent *event, sptr<ReportDataCallback> cb);
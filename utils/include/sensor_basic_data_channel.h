@@ -16,8 +16,11 @@
 #ifndef SENSOR_BASIC_DATA_CHANNEL_H
 #define SENSOR_BASIC_DATA_CHANNEL_H
 
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 
 #include "message_parcel.h"
 #include "refbase.h"
@@ -36,29 +39,86 @@ struct TransferSensorEvents {
     uint32_t dataLen;
     uint8_t data[SENSOR_MAX_LENGTH];
 };
+// What a channel does with new events once its send backlog is full
+enum BacklogPolicy : int32_t {
+    BACKLOG_DROP_OLDEST = 0,
+    BACKLOG_DROP_NEWEST = 1,
+    BACKLOG_COALESCE_LATEST = 2,
+};
+// Layout of the events in a socket datagram, agreed on when the client hands the channel to the service
+enum WireFormat : int32_t {
+    WIRE_FORMAT_LEGACY = 0,
+    WIRE_FORMAT_COMPACT = 1,
+    WIRE_FORMAT_COMPACT_DELTA = 2,
+    WIRE_FORMAT_MAX,
+};
+// Delivery state of the client behind a channel, derived from how far its backlog falls behind
+enum ConsumerState : int32_t {
+    CONSUMER_NORMAL = 0,
+    CONSUMER_DEGRADED = 1,
+    CONSUMER_PAUSED = 2,
+};
+class SensorSharedRing;
 class SensorBasicDataChannel : public RefBase {
 public:
     SensorBasicDataChannel();
     virtual ~SensorBasicDataChannel();
     int32_t CreateSensorBasicChannel();
     int32_t CreateSensorBasicChannel(MessageParcel &data);
+    int32_t CreateSharedRing(uint32_t capacity);
+    std::shared_ptr<SensorSharedRing> GetSharedRing() const;
     int32_t DestroySensorBasicChannel();
     int32_t GetSendDataFd() const;
     int32_t GetReceiveDataFd() const;
     int32_t SendToBinder(MessageParcel &data);
+    int32_t SetSendBufferSize(size_t eventCount);
+    void SetWireFormat(int32_t wireFormat);
+    WireFormat GetWireFormat() const;
+    void SetDeltaQuantum(uint32_t sensorTypeId, float quantum);
     void CloseSendFd();
     int32_t SendData(const void *vaddr, size_t size);
+    int32_t SendEventBatch(const struct TransferSensorEvents *events, size_t count, size_t &sentCount);
     int32_t ReceiveData(void *vaddr, size_t size);
     bool GetSensorStatus() const;
     void SetSensorStatus(bool isActive);
-    const std::unordered_map<uint32_t, struct SensorEvent> &GetDataCacheBuf() const;
+    void SetBacklogPolicy(BacklogPolicy policy, size_t capacity);
+    bool HasBacklog() const;
+    size_t GetBacklogSize() const;
+    uint64_t GetBacklogDroppedCount() const;
+    void EnqueueBacklog(const struct TransferSensorEvents *events, size_t count);
+    int32_t FlushBacklog();
+    ConsumerState GetConsumerState() const;
+    ConsumerState UpdateConsumerState();
+    void CountPausedDrop(size_t count);
+    uint64_t GetDegradedCount() const;
 
 private:
     int32_t sendFd_;
     int32_t receiveFd_;
+    int32_t sendBufferSize_ = 0;
+    std::atomic<int32_t> wireFormat_ { WIRE_FORMAT_LEGACY };
+    // Compact datagrams are encoded here, dispatch workers of different sensors may send on the same channel
+    std::mutex encodeMutex_;
+    std::vector<uint8_t> encodeBuffer_;
+    // Sensors the client asked to receive as quantized deltas, with the step size of each
+    std::unordered_map<uint32_t, float> deltaQuanta_;
     bool isActive_;
     std::mutex statusLock_;
-    std::unordered_map<uint32_t, struct SensorEvent> dataCacheBuf_;
+    void PushBacklog(const struct TransferSensorEvents &event);
+    // Events the socket did not take yet, kept in order and sent ahead of anything newer
+    std::mutex backlogMutex_;
+    BacklogPolicy backlogPolicy_;
+    size_t backlogCapacity_;
+    size_t backlogHead_ = 0;
+    std::atomic<size_t> backlogSize_ { 0 };
+    std::atomic<uint64_t> backlogDroppedCount_ { 0 };
+    std::vector<struct TransferSensorEvents> backlog_;
+    std::atomic<int32_t> consumerState_ { CONSUMER_NORMAL };
+    std::atomic<uint64_t> degradedCount_ { 0 };
+    int64_t stateSinceNs_ = 0;
+    int64_t backlogFullSinceNs_ = 0;
+    // Published with std::atomic_store, the listener keeps its own reference while it drains the ring
+    std::shared_ptr<SensorSharedRing> sharedRing_;
 };
 }  // namespace Sensors
 }  // namespace OHOS
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SENSOR_DECIMATION_H
+#define SENSOR_DECIMATION_H
+
+#include <cstdint>
+
+namespace OHOS {
+namespace Sensors {
+/*
+ * Sampling schedule of a subscriber that asked for a longer period than the stream it shares runs at. Used by the
+ * service for every channel and by the client for users sharing one subscription, so both thin a stream the same way.
+ */
+class SensorDecimation {
+public:
+    SensorDecimation() = default;
+    virtual ~SensorDecimation() = default;
+    // nextDueTimestamp is the state of one subscriber, 0 until its first sample
+    static bool IsSampleDue(int64_t &nextDueTimestamp, int64_t timestamp, int64_t samplingPeriodNs,
+        int64_t toleranceNs);
+};
+}  // namespace Sensors
+}  // namespace OHOS
+#endif  // SENSOR_DECIMATION_H
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SENSOR_EVENT_RING_H
+#define SENSOR_EVENT_RING_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+#include "nocopyable.h"
+
+#include "sensor_agent_type.h"
+
+namespace OHOS {
+namespace Sensors {
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+/*
+ * Single-producer/single-consumer ring of sensor events.
+ * The producer is the HDI reporting thread, the consumer is the data dispatcher thread.
+ * Indices grow monotonically and are masked on access, the capacity is rounded up to a power of two.
+ * The consumer only sleeps when the ring is empty and the producer only signals when the consumer sleeps.
+ * Payloads are copied into a slab preallocated with the slots, so SensorEvent::data of a slot always points
+ * into ring-owned memory and is only valid until the slot is consumed.
+ */
+class SensorEventRing {
+public:
+    SensorEventRing(uint32_t capacity, uint32_t payloadSize);
+    ~SensorEventRing();
+    bool Push(const struct SensorEvent &event);
+    uint32_t PushBatch(const struct SensorEvent *events, uint32_t count);
+    uint32_t Available() const;
+    struct SensorEvent &At(uint32_t offset);
+    void Consume(uint32_t count);
+    void WaitForData();
+    uint32_t GetCapacity() const;
+    uint64_t GetDroppedCount() const;
+    uint64_t GetPayloadAllocCount() const;
+
+private:
+    struct RingSlot {
+        struct SensorEvent event;
+        uint32_t payloadCapacity;
+        uint8_t *heapPayload;
+    };
+    DISALLOW_COPY_AND_MOVE(SensorEventRing);
+    void NotifyConsumer();
+    bool ReservePayload(RingSlot &slot, uint32_t dataLen);
+    bool WriteSlot(RingSlot &slot, const struct SensorEvent &event);
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> writePos_ { 0 };
+    uint32_t cachedReadPos_ { 0 };
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> readPos_ { 0 };
+    alignas(CACHE_LINE_SIZE) std::atomic<bool> consumerWaiting_ { false };
+    std::atomic<uint64_t> droppedCount_ { 0 };
+    std::atomic<uint64_t> payloadAllocCount_ { 0 };
+    std::mutex waitMutex_;
+    std::condition_variable waitCondition_;
+    uint32_t capacity_;
+    uint32_t mask_;
+    RingSlot *slots_ = nullptr;
+    uint8_t *payloadSlab_ = nullptr;
+};
+}  // namespace Sensors
+}  // namespace OHOS
+#endif  // SENSOR_EVENT_RING_H
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SENSOR_SHARED_RING_H
+#define SENSOR_SHARED_RING_H
+
+#include <atomic>
+#include <mutex>
+
+#include "nocopyable.h"
+
+#include "sensor_basic_data_channel.h"
+#include "sensor_event_ring.h"
+
+namespace OHOS {
+namespace Sensors {
+/*
+ * Event ring in a sealed memfd mapping shared between the sensor service (single writer) and a client process
+ * (any number of readers). The client creates the memfd and the eventfd and hands both over with the data channel.
+ * Every slot carries the sequence number it was written with, readers keep their own cursor and detect overruns
+ * themselves, so the writer never waits on them. The eventfd is only signalled when a reader has announced that it
+ * is going to sleep.
+ */
+class SensorSharedRing {
+public:
+    SensorSharedRing() = default;
+    ~SensorSharedRing();
+    int32_t Create(uint32_t capacity);
+    int32_t Attach(int32_t memFd, int32_t eventFd);
+    int32_t GetMemFd() const;
+    int32_t GetEventFd() const;
+    int32_t Write(const struct TransferSensorEvents *events, uint32_t count);
+    uint64_t GetWriteCursor() const;
+    uint32_t Read(uint64_t &cursor, struct TransferSensorEvents *events, uint32_t maxCount, uint64_t &lostCount) const;
+    void BeginWait();
+    void EndWait();
+    void ClearWakeup() const;
+
+private:
+    struct RingHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t capacity;
+        uint32_t slotSize;
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> writeCursor;
+        alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> waitingReaders;
+    };
+    struct alignas(CACHE_LINE_SIZE) RingSlot {
+        std::atomic<uint64_t> sequence;
+        struct TransferSensorEvents event;
+    };
+    DISALLOW_COPY_AND_MOVE(SensorSharedRing);
+    int32_t Map(int32_t memFd, size_t mapSize);
+    void Release();
+    int32_t memFd_ = -1;
+    int32_t eventFd_ = -1;
+    void *mapAddr_ = nullptr;
+    size_t mapSize_ = 0;
+    RingHeader *header_ = nullptr;
+    RingSlot *slots_ = nullptr;
+    uint32_t capacity_ = 0;
+    uint32_t mask_ = 0;
+    uint64_t writeCursor_ = 0;
+    std::mutex writeMutex_;
+};
+}  // namespace Sensors
+}  // namespace OHOS
+#endif  // SENSOR_SHARED_RING_H
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SENSOR_WIRE_FORMAT_H
+#define SENSOR_WIRE_FORMAT_H
+
+#include "sensor_basic_data_channel.h"
+
+namespace OHOS {
+namespace Sensors {
+// Payload layout of a compact record
+enum CompactEncoding : uint32_t {
+    COMPACT_ENCODING_RAW = 0,
+    COMPACT_ENCODING_DELTA = 1,
+};
+/*
+ * Compact socket records: a fixed header followed by exactly dataLen payload bytes, padded to 8 bytes so the
+ * next header stays aligned. A 4-byte ambient light value takes 40 bytes instead of a full TransferSensorEvents.
+ */
+struct CompactEventHeader {
+    int64_t timestamp;
+    uint32_t sensorTypeId;
+    int32_t version;
+    int32_t option;
+    int32_t mode;
+    uint32_t dataLen;
+    uint32_t encoding;
+};
+/*
+ * A delta record starts like a raw one, the header and the float axes are the exact keyframe. This block follows
+ * with deltaCount more events of the same sensor: their uint32 timestamp steps, then per event one int16 step per
+ * axis in units of quantum. Steps are taken between quantized levels, so the error stays below half a quantum
+ * however long the block is.
+ */
+struct DeltaBlockHeader {
+    uint32_t deltaCount;
+    float quantum;
+};
+
+class SensorWireFormat {
+public:
+    SensorWireFormat() = default;
+    virtual ~SensorWireFormat() = default;
+    static size_t GetCompactEventSize(const struct TransferSensorEvents &event);
+    static size_t EncodeCompactEvent(const struct TransferSensorEvents &event, uint8_t *buffer, size_t size);
+    static size_t EncodeDeltaBlock(const struct TransferSensorEvents *events, size_t count, float quantum,
+        uint8_t *buffer, size_t size, size_t &encodedCount);
+    static size_t DecodeCompactEvents(const uint8_t *buffer, size_t length, struct TransferSensorEvents *events,
+        size_t maxCount);
+};
+}  // namespace Sensors
+}  // namespace OHOS
+#endif  // SENSOR_WIRE_FORMAT_H
@@ -99,6 +99,9 @@ enum {
     SENSOR_CHANNEL_RESTORE_CB_ERR = SENSOR_CHANNEL_RECEIVE_ADDR_ERR + 1,
     SENSOR_CHANNEL_RESTORE_FD_ERR = SENSOR_CHANNEL_RESTORE_CB_ERR + 1,
     SENSOR_CHANNEL_RESTORE_THREAD_ERR = SENSOR_CHANNEL_RESTORE_FD_ERR + 1,
+    SENSOR_CHANNEL_SHARED_RING_CREATE_ERR = SENSOR_CHANNEL_RESTORE_THREAD_ERR + 1,
+    SENSOR_CHANNEL_SHARED_RING_MAP_ERR = SENSOR_CHANNEL_SHARED_RING_CREATE_ERR + 1,
+    SENSOR_CHANNEL_SET_BUFFER_ERR = SENSOR_CHANNEL_SHARED_RING_MAP_ERR + 1,
 };
 // Error code for Sensor native
 constexpr ErrCode SENSOR_NATIVE_ERR_OFFSET = ErrCodeOffset(SUBSYS_SENSORS, MODULE_SENSORS_NATIVE);
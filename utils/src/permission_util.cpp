@@ -15,7 +15,11 @@
 
 #include "permission_util.h"
 
-#include <thread>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <vector>
+
 #include "sensor_agent_type.h"
 #include "sensors_errors.h"
 #include "sensors_log_domain.h"
@@ -30,6 +34,23 @@ const std::string ACCELEROMETER_PERMISSION = "ohos.permission.ACCELEROMETER";
 const std::string GYROSCOPE_PERMISSION = "ohos.permission.GYROSCOPE";
 const std::string ACTIVITY_MOTION_PERMISSION = "ohos.permission.ACTIVITY_MOTION";
 const std::string READ_HEALTH_DATA_PERMISSION = "ohos.permission.READ_HEALTH_DATA";
+constexpr uint32_t TOKEN_SHIFT = 32;
+constexpr std::chrono::milliseconds PERMISSION_REFRESH_INTERVAL { 1000 };
+// A grant older than this is verified again before the data path sends anything more on it
+constexpr int64_t PERMISSION_GRANT_TTL_NS = 100000000;
+// Entries no dispatch table refers to, e.g. of GetSensorState callers, are dropped once unused for this long
+constexpr int64_t PERMISSION_IDLE_TIMEOUT_NS = 10000000000;
+
+uint64_t GetPermissionKey(AccessTokenID callerToken, int32_t sensorTypeId)
+{
+    return (static_cast<uint64_t>(callerToken) << TOKEN_SHIFT) | static_cast<uint32_t>(sensorTypeId);
+}
+
+int64_t GetSteadyTimeNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 }  // namespace
 
 std::unordered_map<uint32_t, std::string> PermissionUtil::sensorPermissions_ = {
@@ -43,7 +64,239 @@ std::unordered_map<uint32_t, std::string> PermissionUtil::sensorPermissions_ = {
     { SENSOR_TYPE_ID_HEART_RATE, READ_HEALTH_DATA_PERMISSION }
 };
 
+PermissionUtil::~PermissionUtil()
+{
+    StopPermissionMonitor();
+}
+
 bool PermissionUtil::CheckSensorPermission(AccessTokenID callerToken, int32_t sensorTypeId)
+{
+    if (sensorPermissions_.find(sensorTypeId) == sensorPermissions_.end()) {
+        return true;
+    }
+    int64_t verifiedTime = GetSteadyTimeNs();
+    bool granted = VerifySensorPermission(callerToken, sensorTypeId);
+    bool changed = false;
+    bool inserted = false;
+    PermissionChangedCallback callback;
+    {
+        std::lock_guard<std::mutex> permissionLock(permissionMutex_);
+        auto result = permissionCache_.insert(std::make_pair(GetPermissionKey(callerToken, sensorTypeId),
+            PermissionDecision()));
+        PermissionDecision &decision = result.first->second;
+        inserted = result.second;
+        // Seeded here, outside the client locks, so building the dispatch table rarely has to verify
+        changed = !inserted && decision.granted != granted;
+        decision.granted = granted;
+        decision.verifiedTime = verifiedTime;
+        decision.usedTime = verifiedTime;
+        if (changed) {
+            callback = permissionChangedCallback_;
+        }
+    }
+    if (inserted) {
+        WakePermissionMonitor();
+    }
+    // A fresh check that disagrees with the cache is handled like a change found by the monitor
+    if (changed && callback != nullptr) {
+        callback(callerToken, sensorTypeId, granted);
+    }
+    return granted;
+}
+
+bool PermissionUtil::PeekSensorPermission(AccessTokenID callerToken, int32_t sensorTypeId, bool &granted)
+{
+    if (sensorPermissions_.find(sensorTypeId) == sensorPermissions_.end()) {
+        granted = true;
+        return true;
+    }
+    // Never calls the access token kit, so it is safe under the locks of the callers
+    std::lock_guard<std::mutex> permissionLock(permissionMutex_);
+    auto cacheIt = permissionCache_.find(GetPermissionKey(callerToken, sensorTypeId));
+    if (cacheIt == permissionCache_.end()) {
+        return false;
+    }
+    cacheIt->second.isWatched = true;
+    granted = cacheIt->second.granted;
+    return true;
+}
+
+bool PermissionUtil::RenewSensorPermission(AccessTokenID callerToken, int32_t sensorTypeId, int64_t &grantExpiry)
+{
+    int64_t now = GetSteadyTimeNs();
+    if (now < grantExpiry) {
+        return true;
+    }
+    if (sensorPermissions_.find(sensorTypeId) == sensorPermissions_.end()) {
+        grantExpiry = std::numeric_limits<int64_t>::max();
+        return true;
+    }
+    {
+        std::lock_guard<std::mutex> permissionLock(permissionMutex_);
+        auto cacheIt = permissionCache_.find(GetPermissionKey(callerToken, sensorTypeId));
+        if (cacheIt != permissionCache_.end() && cacheIt->second.granted &&
+            now - cacheIt->second.verifiedTime < PERMISSION_GRANT_TTL_NS) {
+            // Verified recently by a control call or the monitor
+            cacheIt->second.usedTime = now;
+            grantExpiry = cacheIt->second.verifiedTime + PERMISSION_GRANT_TTL_NS;
+            return true;
+        }
+    }
+    // The cached grant is stale, ask the access token kit before any more data goes out on it
+    bool granted = CheckSensorPermission(callerToken, sensorTypeId);
+    grantExpiry = granted ? (now + PERMISSION_GRANT_TTL_NS) : 0;
+    return granted;
+}
+
+void PermissionUtil::ClearPermissionCache(AccessTokenID callerToken)
+{
+    std::lock_guard<std::mutex> permissionLock(permissionMutex_);
+    for (auto it = permissionCache_.begin(); it != permissionCache_.end();) {
+        if ((it->first >> TOKEN_SHIFT) == callerToken) {
+            it = permissionCache_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void PermissionUtil::SetPermissionChangedCallback(PermissionChangedCallback callback)
+{
+    std::lock_guard<std::mutex> permissionLock(permissionMutex_);
+    permissionChangedCallback_ = callback;
+}
+
+void PermissionUtil::RefreshPermissionCache()
+{
+    RefreshPermissions(nullptr);
+}
+
+void PermissionUtil::RefreshPermissionCache(AccessTokenID callerToken)
+{
+    RefreshPermissions(&callerToken);
+}
+
+void PermissionUtil::RefreshPermissions(const AccessTokenID *callerToken)
+{
+    int64_t verifiedTime = GetSteadyTimeNs();
+    std::vector<uint64_t> keys;
+    {
+        std::lock_guard<std::mutex> permissionLock(permissionMutex_);
+        keys.reserve(permissionCache_.size());
+        for (auto it = permissionCache_.begin(); it != permissionCache_.end();) {
+            if (callerToken != nullptr && (it->first >> TOKEN_SHIFT) != *callerToken) {
+                ++it;
+                continue;
+            }
+            if (!it->second.isWatched && verifiedTime - it->second.usedTime > PERMISSION_IDLE_TIMEOUT_NS) {
+                it = permissionCache_.erase(it);
+                continue;
+            }
+            keys.push_back(it->first);
+            ++it;
+        }
+    }
+    // The access token kit is called without holding any lock, callers may sit behind the cache meanwhile
+    std::vector<std::pair<uint64_t, bool>> decisions;
+    decisions.reserve(keys.size());
+    for (uint64_t key : keys) {
+        AccessTokenID token = static_cast<AccessTokenID>(key >> TOKEN_SHIFT);
+        int32_t sensorTypeId = static_cast<int32_t>(static_cast<uint32_t>(key));
+        decisions.push_back(std::make_pair(key, VerifySensorPermission(token, sensorTypeId)));
+    }
+    std::vector<std::pair<uint64_t, bool>> changes;
+    PermissionChangedCallback callback;
+    {
+        std::lock_guard<std::mutex> permissionLock(permissionMutex_);
+        for (const auto &decision : decisions) {
+            auto cacheIt = permissionCache_.find(decision.first);
+            if (cacheIt == permissionCache_.end()) {
+                continue;
+            }
+            if (cacheIt->second.granted != decision.second) {
+                cacheIt->second.granted = decision.second;
+                changes.push_back(decision);
+            }
+            cacheIt->second.verifiedTime = std::max(cacheIt->second.verifiedTime, verifiedTime);
+        }
+        callback = permissionChangedCallback_;
+    }
+    if (callback == nullptr) {
+        return;
+    }
+    for (const auto &change : changes) {
+        callback(static_cast<AccessTokenID>(change.first >> TOKEN_SHIFT),
+            static_cast<int32_t>(static_cast<uint32_t>(change.first)), change.second);
+    }
+}
+
+bool PermissionUtil::IsPermissionCacheEmpty()
+{
+    std::lock_guard<std::mutex> permissionLock(permissionMutex_);
+    return permissionCache_.empty();
+}
+
+void PermissionUtil::StartPermissionMonitor()
+{
+    {
+        std::lock_guard<std::mutex> monitorLock(monitorMutex_);
+        isMonitorEnabled_ = true;
+    }
+    WakePermissionMonitor();
+}
+
+void PermissionUtil::StopPermissionMonitor()
+{
+    std::thread monitorThread;
+    {
+        std::lock_guard<std::mutex> monitorLock(monitorMutex_);
+        isMonitorEnabled_ = false;
+        monitorThread = std::move(monitorThread_);
+    }
+    monitorCondition_.notify_all();
+    if (monitorThread.joinable()) {
+        monitorThread.join();
+    }
+}
+
+bool PermissionUtil::IsPermissionMonitorRunning()
+{
+    std::lock_guard<std::mutex> monitorLock(monitorMutex_);
+    return isMonitorRunning_;
+}
+
+void PermissionUtil::WakePermissionMonitor()
+{
+    std::lock_guard<std::mutex> monitorLock(monitorMutex_);
+    if (!isMonitorEnabled_ || isMonitorRunning_ || IsPermissionCacheEmpty()) {
+        return;
+    }
+    if (monitorThread_.joinable()) {
+        // The last run found the cache empty, it has left its loop and only has to return
+        monitorThread_.join();
+    }
+    isMonitorRunning_ = true;
+    monitorThread_ = std::thread([this] { RunPermissionMonitor(); });
+}
+
+void PermissionUtil::RunPermissionMonitor()
+{
+    std::unique_lock<std::mutex> monitorLock(monitorMutex_);
+    while (!monitorCondition_.wait_for(monitorLock, PERMISSION_REFRESH_INTERVAL,
+        [this] { return !isMonitorEnabled_; })) {
+        monitorLock.unlock();
+        RefreshPermissionCache();
+        monitorLock.lock();
+        // Decided under monitorMutex_, an entry added meanwhile is either seen here or wakes a new run after us
+        if (IsPermissionCacheEmpty()) {
+            SEN_HILOGD("permission cache is empty, stop monitor");
+            break;
+        }
+    }
+    isMonitorRunning_ = false;
+}
+
+bool PermissionUtil::VerifySensorPermission(AccessTokenID callerToken, int32_t sensorTypeId)
 {
     if (sensorPermissions_.find(sensorTypeId) == sensorPermissions_.end()) {
         return true;
@@ -51,7 +304,8 @@ bool PermissionUtil::CheckSensorPermission(AccessTokenID callerToken, int32_t se
     std::string permissionName = sensorPermissions_[sensorTypeId];
     int32_t result = AccessTokenKit::VerifyAccessToken(callerToken, permissionName);
     if (result != PERMISSION_GRANTED) {
-        SEN_HILOGE("sensorId: %{public}d grant failed, result: %{public}d", sensorTypeId, result);
+        // Re-verified periodically, a denial is logged once by the permission changed callback instead
+        SEN_HILOGD("sensorId: %{public}d grant failed, result: %{public}d", sensorTypeId, result);
         return false;
     }
     SEN_HILOGD("sensorId: %{public}d grant success", sensorTypeId);
@@ -15,8 +15,8 @@
 
 #include "report_data_callback.h"
 
-#include <cstdlib>
-#include <cstring>
+#include <algorithm>
+#include <cinttypes>
 
 #include "errors.h"
 #include "securec.h"
@@ -31,68 +31,111 @@ namespace {
 constexpr OHOS::HiviewDFX::HiLogLabel LABEL = {
     LOG_CORE, SensorsLogDomain::SENSOR_UTILS, "ReportDataCallback"
 };
+constexpr uint64_t DROP_LOG_INTERVAL = 1000;
+constexpr uint32_t SHARD_BATCH_SIZE = 128;
 }  // namespace
-ReportDataCallback::ReportDataCallback()
+ReportDataCallback::ReportDataCallback(uint32_t ringCount)
 {
-    eventsBuf_.circularBuf = new struct SensorEvent[CIRCULAR_BUF_LEN];
-    eventsBuf_.readPos = 0;
-    eventsBuf_.writePosition = 0;
-    eventsBuf_.eventNum = 0;
-}
-
-ReportDataCallback::~ReportDataCallback()
-{
-    if (eventsBuf_.circularBuf != nullptr) {
-        delete[] eventsBuf_.circularBuf;
+    ringCount = std::max(1U, std::min(ringCount, MAX_EVENT_RING_COUNT));
+    for (uint32_t i = 0; i < ringCount; i++) {
+        std::unique_ptr<SensorEventRing> eventsRing(
+            new (std::nothrow) SensorEventRing(CIRCULAR_BUF_LEN, SENSOR_DATA_LENGHT));
+        if (eventsRing == nullptr) {
+            SEN_HILOGE("alloc event ring failed, index : %{public}u", i);
+            break;
+        }
+        eventsRings_.push_back(std::move(eventsRing));
     }
-    eventsBuf_.circularBuf = nullptr;
-    eventsBuf_.readPos = 0;
-    eventsBuf_.writePosition = 0;
-    eventsBuf_.eventNum = 0;
 }
 
 int32_t ReportDataCallback::ReportEventCallback(const struct SensorEvent* event, sptr<ReportDataCallback> cb)
 {
     CHKPR(event, ERROR);
-    if (cb == nullptr || cb->eventsBuf_.circularBuf == nullptr) {
-        SEN_HILOGE("callback or circularBuf or event cannot be null");
-        if (event->data != nullptr) {
-            delete[] event->data;
-        }
+    return ReportEventsCallback(event, 1, cb);
+}
+
+int32_t ReportDataCallback::ReportEventsCallback(const struct SensorEvent *events, int32_t count,
+                                                 sptr<ReportDataCallback> cb)
+{
+    CHKPR(events, ERROR);
+    if (cb == nullptr) {
+        SEN_HILOGE("callback cannot be null");
         return ERROR;
     }
-    int32_t leftSize = CIRCULAR_BUF_LEN - cb->eventsBuf_.eventNum;
-    int32_t toEndLen = CIRCULAR_BUF_LEN - cb->eventsBuf_.writePosition;
-    if (leftSize < 0 || toEndLen < 0) {
-        SEN_HILOGE("Leftsize and toendlen cannot be less than zero");
-        if (event->data != nullptr) {
-            delete[] event->data;
-        }
+    if (count <= 0) {
+        SEN_HILOGE("count is invalid, count : %{public}d", count);
         return ERROR;
     }
-    if (toEndLen == 0) {
-            cb->eventsBuf_.circularBuf[0] = *event;
-            cb->eventsBuf_.writePosition = 1 - toEndLen;
-    } else {
-            cb->eventsBuf_.circularBuf[cb->eventsBuf_.writePosition] = *event;
-            cb->eventsBuf_.writePosition += 1;
-    }
-    if (leftSize < 1) {
-        cb->eventsBuf_.readPos = cb->eventsBuf_.writePosition;
-    }
-    cb->eventsBuf_.eventNum += 1;
-    if (cb->eventsBuf_.eventNum >= CIRCULAR_BUF_LEN) {
-        cb->eventsBuf_.eventNum = CIRCULAR_BUF_LEN;
+    if (cb->eventsRings_.empty()) {
+        SEN_HILOGE("event ring is not created");
+        return ERROR;
     }
-    if (cb->eventsBuf_.writePosition == CIRCULAR_BUF_LEN) {
-        cb->eventsBuf_.writePosition = 0;
+    uint32_t pushCount = (cb->eventsRings_.size() == 1) ?
+        cb->eventsRings_[0]->PushBatch(events, static_cast<uint32_t>(count)) :
+        cb->PushShardedEvents(events, static_cast<uint32_t>(count));
+    if (pushCount != static_cast<uint32_t>(count)) {
+        // The dispatcher is behind, drop the newest events rather than overwrite ones it may be reading
+        uint64_t droppedCount = cb->GetDroppedCount();
+        uint64_t lastDroppedCount = droppedCount - (static_cast<uint32_t>(count) - pushCount);
+        if ((lastDroppedCount == 0) || (lastDroppedCount / DROP_LOG_INTERVAL != droppedCount / DROP_LOG_INTERVAL)) {
+            SEN_HILOGW("push events failed, dropped count : %{public}" PRIu64, droppedCount);
+        }
+        return ERROR;
     }
     return ERR_OK;
 }
 
-struct CircularEventBuf &ReportDataCallback::GetEventData()
+uint32_t ReportDataCallback::GetRingIndex(int32_t sensorTypeId) const
+{
+    // Sensor ids are built from byte-sized fields, fold them so the low bits differ between sensors
+    uint32_t sensorId = static_cast<uint32_t>(sensorTypeId);
+    uint32_t hash = sensorId ^ (sensorId >> 8) ^ (sensorId >> 16) ^ (sensorId >> 24);
+    return hash % static_cast<uint32_t>(eventsRings_.size());
+}
+
+uint32_t ReportDataCallback::PushShardedEvents(const struct SensorEvent *events, uint32_t count)
+{
+    uint32_t ringIndexes[SHARD_BATCH_SIZE];
+    struct SensorEvent shardEvents[SHARD_BATCH_SIZE];
+    uint32_t pushCount = 0;
+    for (uint32_t begin = 0; begin < count; begin += SHARD_BATCH_SIZE) {
+        uint32_t num = std::min(count - begin, SHARD_BATCH_SIZE);
+        for (uint32_t i = 0; i < num; i++) {
+            ringIndexes[i] = GetRingIndex(events[begin + i].sensorTypeId);
+        }
+        // Keep one push per ring and batch so every worker is woken at most once
+        for (uint32_t ringIndex = 0; ringIndex < eventsRings_.size(); ringIndex++) {
+            uint32_t shardCount = 0;
+            for (uint32_t i = 0; i < num; i++) {
+                if (ringIndexes[i] == ringIndex) {
+                    shardEvents[shardCount++] = events[begin + i];
+                }
+            }
+            if (shardCount != 0) {
+                pushCount += eventsRings_[ringIndex]->PushBatch(shardEvents, shardCount);
+            }
+        }
+    }
+    return pushCount;
+}
+
+uint32_t ReportDataCallback::GetEventRingCount() const
 {
-    return eventsBuf_;
+    return static_cast<uint32_t>(eventsRings_.size());
+}
+
+SensorEventRing &ReportDataCallback::GetEventData(uint32_t ringIndex)
+{
+    return *eventsRings_[ringIndex % eventsRings_.size()];
+}
+
+uint64_t ReportDataCallback::GetDroppedCount() const
+{
+    uint64_t droppedCount = 0;
+    for (const auto &eventsRing : eventsRings_) {
+        droppedCount += eventsRing->GetDroppedCount();
+    }
+    return droppedCount;
 }
 }  // namespace Sensors
 }  // namespace OHOS
@@ -15,11 +15,17 @@
 
 #include "sensor_basic_data_channel.h"
 
+#include <algorithm>
+#include <chrono>
+
 #include <fcntl.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include "dmd_report.h"
+#include "sensor_shared_ring.h"
+#include "sensor_wire_format.h"
 #include "sensors_errors.h"
 #include "sensors_log_domain.h"
 
@@ -29,12 +35,61 @@ using namespace OHOS::HiviewDFX;
 
 namespace {
 constexpr HiLogLabel LABEL = { LOG_CORE, SensorsLogDomain::SENSOR_UTILS, "SensorBasicChannel" };
-constexpr int32_t SENSOR_READ_DATA_SIZE = sizeof(struct SensorEvent) * 100;
+constexpr int32_t SENSOR_READ_DATA_SIZE = sizeof(struct TransferSensorEvents) * 100;
 constexpr int32_t DEFAULT_CHANNEL_SIZE = 2 * 1024;
 constexpr int32_t SOCKET_PAIR_SIZE = 2;
+// The client receives at most this many events per recv, larger datagrams would be truncated
+constexpr size_t MAX_EVENTS_PER_DATAGRAM = 100;
+constexpr uint32_t MAX_DATAGRAMS_PER_SEND = 16;
+constexpr size_t MIN_SEND_BUFFER_EVENTS = 100;
+// Two full FIFO batches of the largest allowed size, one in flight and one being sent
+constexpr size_t MAX_SEND_BUFFER_EVENTS = 2000;
+constexpr size_t DEFAULT_BACKLOG_CAPACITY = 256;
+constexpr size_t MAX_BACKLOG_CAPACITY = 4096;
+// A client stays in a state at least this long before it is trusted to recover
+constexpr int64_t CONSUMER_STATE_HOLD_NS = 1000000000;
+// A backlog that stays full this long pauses delivery until the client reads again
+constexpr int64_t CONSUMER_PAUSE_AFTER_NS = 2000000000;
+
+size_t EncodeCompactDatagram(const struct TransferSensorEvents *events, size_t count, uint8_t *buffer, size_t size,
+    const std::unordered_map<uint32_t, float> *deltaQuanta)
+{
+    size_t length = 0;
+    size_t index = 0;
+    while (index < count) {
+        size_t recordSize = 0;
+        size_t encodedCount = 0;
+        if (deltaQuanta != nullptr) {
+            // FIFO batches arrive as runs of one sensor, each run becomes a keyframe and its deltas
+            auto quantumIt = deltaQuanta->find(events[index].sensorTypeId);
+            if (quantumIt != deltaQuanta->end()) {
+                recordSize = SensorWireFormat::EncodeDeltaBlock(events + index, count - index, quantumIt->second,
+                    buffer + length, size - length, encodedCount);
+            }
+        }
+        if (recordSize == 0) {
+            recordSize = SensorWireFormat::EncodeCompactEvent(events[index], buffer + length, size - length);
+            encodedCount = 1;
+        }
+        if (recordSize == 0) {
+            return 0;
+        }
+        length += recordSize;
+        index += encodedCount;
+    }
+    return length;
+}
+
+int64_t GetSteadyTimeNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 }  // namespace
 
-SensorBasicDataChannel::SensorBasicDataChannel() : sendFd_(-1), receiveFd_(-1), isActive_(false)
+SensorBasicDataChannel::SensorBasicDataChannel()
+    : sendFd_(-1), receiveFd_(-1), isActive_(false), backlogPolicy_(BACKLOG_DROP_OLDEST),
+      backlogCapacity_(DEFAULT_BACKLOG_CAPACITY)
 {
     SEN_HILOGD("isActive_ : %{public}d, sendFd: %{public}d", isActive_, sendFd_);
 }
@@ -113,14 +168,94 @@ int32_t SensorBasicDataChannel::CreateSensorBasicChannel(MessageParcel &data)
         sendFd_ = -1;
         return SENSOR_CHANNEL_DUP_ERR;
     }
+    if (!data.ReadBool()) {
+        return ERR_OK;
+    }
+    int32_t memFd = data.ReadFileDescriptor();
+    int32_t eventFd = data.ReadFileDescriptor();
+    auto sharedRing = std::make_shared<SensorSharedRing>();
+    int32_t ret = sharedRing->Attach((memFd < 0) ? -1 : dup(memFd), (eventFd < 0) ? -1 : dup(eventFd));
+    if (ret != ERR_OK) {
+        // The client keeps listening on the socket as well, so the channel still works without the ring
+        SEN_HILOGW("attach shared ring failed, fall back to socket, ret : %{public}d", ret);
+        return ERR_OK;
+    }
+    std::atomic_store(&sharedRing_, sharedRing);
     return ERR_OK;
 }
 
+int32_t SensorBasicDataChannel::CreateSharedRing(uint32_t capacity)
+{
+    if (GetSharedRing() != nullptr) {
+        SEN_HILOGD("already create shared ring");
+        return ERR_OK;
+    }
+    auto sharedRing = std::make_shared<SensorSharedRing>();
+    int32_t ret = sharedRing->Create(capacity);
+    if (ret != ERR_OK) {
+        SEN_HILOGE("create shared ring failed, ret : %{public}d", ret);
+        return ret;
+    }
+    std::atomic_store(&sharedRing_, sharedRing);
+    return ERR_OK;
+}
+
+std::shared_ptr<SensorSharedRing> SensorBasicDataChannel::GetSharedRing() const
+{
+    return std::atomic_load(&sharedRing_);
+}
+
 SensorBasicDataChannel::~SensorBasicDataChannel()
 {
     DestroySensorBasicChannel();
 }
 
+int32_t SensorBasicDataChannel::SetSendBufferSize(size_t eventCount)
+{
+    if (sendFd_ < 0) {
+        SEN_HILOGE("sendFd is invalid");
+        return SENSOR_CHANNEL_SEND_ADDR_ERR;
+    }
+    eventCount = std::max(std::min(eventCount, MAX_SEND_BUFFER_EVENTS), MIN_SEND_BUFFER_EVENTS);
+    int32_t bufferSize = static_cast<int32_t>(eventCount * sizeof(struct TransferSensorEvents));
+    if (bufferSize == sendBufferSize_) {
+        return ERR_OK;
+    }
+    // SO_SNDBUFFORCE is not capped by wmem_max but needs CAP_NET_ADMIN, fall back to the capped option without it
+    if (setsockopt(sendFd_, SOL_SOCKET, SO_SNDBUFFORCE, &bufferSize, sizeof(bufferSize)) != 0 &&
+        setsockopt(sendFd_, SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize)) != 0) {
+        SEN_HILOGE("set send buffer failed, errno : %{public}d, size : %{public}d", errno, bufferSize);
+        return SENSOR_CHANNEL_SET_BUFFER_ERR;
+    }
+    SEN_HILOGD("send buffer : %{public}d -> %{public}d", sendBufferSize_, bufferSize);
+    sendBufferSize_ = bufferSize;
+    return ERR_OK;
+}
+
+void SensorBasicDataChannel::SetWireFormat(int32_t wireFormat)
+{
+    if (wireFormat < WIRE_FORMAT_LEGACY || wireFormat >= WIRE_FORMAT_MAX) {
+        SEN_HILOGW("unknown wire format : %{public}d, use legacy", wireFormat);
+        wireFormat = WIRE_FORMAT_LEGACY;
+    }
+    wireFormat_.store(wireFormat, std::memory_order_relaxed);
+}
+
+WireFormat SensorBasicDataChannel::GetWireFormat() const
+{
+    return static_cast<WireFormat>(wireFormat_.load(std::memory_order_relaxed));
+}
+
+void SensorBasicDataChannel::SetDeltaQuantum(uint32_t sensorTypeId, float quantum)
+{
+    std::lock_guard<std::mutex> encodeLock(encodeMutex_);
+    if (quantum > 0.0f) {
+        deltaQuanta_[sensorTypeId] = quantum;
+    } else {
+        deltaQuanta_.erase(sensorTypeId);
+    }
+}
+
 int32_t SensorBasicDataChannel::SendToBinder(MessageParcel &data)
 {
     SEN_HILOGD("sendFd: %{public}d", sendFd_);
@@ -134,6 +269,16 @@ int32_t SensorBasicDataChannel::SendToBinder(MessageParcel &data)
         CloseSendFd();
         return SENSOR_CHANNEL_WRITE_DESCRIPTOR_ERR;
     }
+    auto sharedRing = GetSharedRing();
+    if (!data.WriteBool(sharedRing != nullptr)) {
+        SEN_HILOGE("write shared ring flag failed");
+        return SENSOR_CHANNEL_WRITE_DESCRIPTOR_ERR;
+    }
+    if (sharedRing != nullptr && (!data.WriteFileDescriptor(sharedRing->GetMemFd()) ||
+        !data.WriteFileDescriptor(sharedRing->GetEventFd()))) {
+        SEN_HILOGE("send shared ring fd failed");
+        return SENSOR_CHANNEL_WRITE_DESCRIPTOR_ERR;
+    }
     return ERR_OK;
 }
 
@@ -149,6 +294,16 @@ void SensorBasicDataChannel::CloseSendFd()
 int32_t SensorBasicDataChannel::SendData(const void *vaddr, size_t size)
 {
     CHKPR(vaddr, SENSOR_CHANNEL_SEND_ADDR_ERR);
+    auto sharedRing = GetSharedRing();
+    if (sharedRing != nullptr && size % sizeof(struct TransferSensorEvents) == 0) {
+        return sharedRing->Write(static_cast<const struct TransferSensorEvents *>(vaddr),
+            static_cast<uint32_t>(size / sizeof(struct TransferSensorEvents)));
+    }
+    if (GetWireFormat() >= WIRE_FORMAT_COMPACT && size % sizeof(struct TransferSensorEvents) == 0) {
+        size_t sentCount = 0;
+        return SendEventBatch(static_cast<const struct TransferSensorEvents *>(vaddr),
+            size / sizeof(struct TransferSensorEvents), sentCount);
+    }
     if (sendFd_ < 0) {
         SEN_HILOGE("failed, param is invalid");
         return SENSOR_CHANNEL_SEND_ADDR_ERR;
@@ -156,14 +311,97 @@ int32_t SensorBasicDataChannel::SendData(const void *vaddr, size_t size)
     ssize_t length;
     do {
         length = send(sendFd_, vaddr, size, MSG_DONTWAIT | MSG_NOSIGNAL);
-    } while (errno == EINTR);
+    } while (length < 0 && errno == EINTR);
     if (length < 0) {
-        SEN_HILOGE("send fail : %{public}d, length = %{public}d", errno, (int32_t)length);
+        SEN_HILOGD("send fail : %{public}d, length = %{public}d", errno, (int32_t)length);
         return SENSOR_CHANNEL_SEND_DATA_ERR;
     }
     return ERR_OK;
 }
 
+int32_t SensorBasicDataChannel::SendEventBatch(const struct TransferSensorEvents *events, size_t count,
+                                               size_t &sentCount)
+{
+    sentCount = 0;
+    CHKPR(events, SENSOR_CHANNEL_SEND_ADDR_ERR);
+    auto sharedRing = GetSharedRing();
+    if (sharedRing != nullptr) {
+        int32_t ret = sharedRing->Write(events, static_cast<uint32_t>(count));
+        sentCount = (ret == ERR_OK) ? count : 0;
+        return ret;
+    }
+    if (sendFd_ < 0) {
+        SEN_HILOGE("failed, param is invalid");
+        return SENSOR_CHANNEL_SEND_ADDR_ERR;
+    }
+    struct iovec iovecs[MAX_DATAGRAMS_PER_SEND];
+    struct mmsghdr msgs[MAX_DATAGRAMS_PER_SEND];
+    size_t eventNums[MAX_DATAGRAMS_PER_SEND];
+    WireFormat wireFormat = GetWireFormat();
+    bool isCompact = (wireFormat >= WIRE_FORMAT_COMPACT);
+    std::unique_lock<std::mutex> encodeLock(encodeMutex_, std::defer_lock);
+    if (isCompact) {
+        encodeLock.lock();
+        // Compact and delta records are never larger than the fixed ones, so this bounds every round
+        size_t roundSize = std::min(count, MAX_DATAGRAMS_PER_SEND * MAX_EVENTS_PER_DATAGRAM) *
+            sizeof(struct TransferSensorEvents);
+        if (encodeBuffer_.size() < roundSize) {
+            encodeBuffer_.resize(roundSize);
+        }
+    }
+    const std::unordered_map<uint32_t, float> *deltaQuanta =
+        (wireFormat >= WIRE_FORMAT_COMPACT_DELTA && !deltaQuanta_.empty()) ? &deltaQuanta_ : nullptr;
+    while (sentCount < count) {
+        uint32_t msgNum = 0;
+        size_t offset = sentCount;
+        size_t encodedSize = 0;
+        while (msgNum < MAX_DATAGRAMS_PER_SEND && offset < count) {
+            size_t num = std::min(count - offset, MAX_EVENTS_PER_DATAGRAM);
+            if (isCompact) {
+                uint8_t *datagram = encodeBuffer_.data() + encodedSize;
+                iovecs[msgNum].iov_base = datagram;
+                iovecs[msgNum].iov_len = EncodeCompactDatagram(events + offset, num, datagram,
+                    encodeBuffer_.size() - encodedSize, deltaQuanta);
+                encodedSize += iovecs[msgNum].iov_len;
+                if (iovecs[msgNum].iov_len == 0) {
+                    SEN_HILOGE("encode compact datagram failed, sent events : %{public}zu", sentCount);
+                    return SENSOR_CHANNEL_SEND_DATA_ERR;
+                }
+            } else {
+                iovecs[msgNum].iov_base = const_cast<struct TransferSensorEvents *>(events + offset);
+                iovecs[msgNum].iov_len = num * sizeof(struct TransferSensorEvents);
+            }
+            eventNums[msgNum] = num;
+            msgs[msgNum] = {};
+            msgs[msgNum].msg_hdr.msg_iov = &iovecs[msgNum];
+            msgs[msgNum].msg_hdr.msg_iovlen = 1;
+            offset += num;
+            msgNum++;
+        }
+        int32_t sentMsgNum;
+        do {
+            sentMsgNum = sendmmsg(sendFd_, msgs, msgNum, MSG_DONTWAIT | MSG_NOSIGNAL);
+        } while (sentMsgNum < 0 && errno == EINTR);
+        if (sentMsgNum <= 0) {
+            // A full socket is expected for slow clients, the backlog accounts for it without flooding the log
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                SEN_HILOGD("socket buffer full, sent events : %{public}zu", sentCount);
+            } else {
+                SEN_HILOGE("sendmmsg fail : %{public}d, sent events : %{public}zu", errno, sentCount);
+            }
+            return SENSOR_CHANNEL_SEND_DATA_ERR;
+        }
+        for (int32_t i = 0; i < sentMsgNum; i++) {
+            sentCount += eventNums[i];
+        }
+        if (static_cast<uint32_t>(sentMsgNum) < msgNum) {
+            SEN_HILOGD("socket buffer full, sent events : %{public}zu of %{public}zu", sentCount, count);
+            return SENSOR_CHANNEL_SEND_DATA_ERR;
+        }
+    }
+    return ERR_OK;
+}
+
 int32_t SensorBasicDataChannel::ReceiveData(void *vaddr, size_t size)
 {
     CHKPR(vaddr, SENSOR_CHANNEL_SEND_ADDR_ERR);
@@ -201,12 +439,154 @@ int32_t SensorBasicDataChannel::DestroySensorBasicChannel()
         receiveFd_ = -1;
         SEN_HILOGD("close receiveFd_ success");
     }
+    // Readers still draining the ring hold their own reference, the mapping goes away with the last one
+    std::atomic_store(&sharedRing_, std::shared_ptr<SensorSharedRing>());
+    return ERR_OK;
+}
+
+void SensorBasicDataChannel::SetBacklogPolicy(BacklogPolicy policy, size_t capacity)
+{
+    std::lock_guard<std::mutex> backlogLock(backlogMutex_);
+    if (backlogSize_.load(std::memory_order_relaxed) != 0) {
+        SEN_HILOGW("backlog is not empty, keep the current policy");
+        return;
+    }
+    backlogPolicy_ = policy;
+    backlogCapacity_ = std::max(std::min(capacity, MAX_BACKLOG_CAPACITY), static_cast<size_t>(1));
+    backlogHead_ = 0;
+    std::vector<struct TransferSensorEvents>().swap(backlog_);
+}
+
+bool SensorBasicDataChannel::HasBacklog() const
+{
+    return backlogSize_.load(std::memory_order_relaxed) != 0;
+}
+
+size_t SensorBasicDataChannel::GetBacklogSize() const
+{
+    return backlogSize_.load(std::memory_order_relaxed);
+}
+
+uint64_t SensorBasicDataChannel::GetBacklogDroppedCount() const
+{
+    return backlogDroppedCount_.load(std::memory_order_relaxed);
+}
+
+void SensorBasicDataChannel::PushBacklog(const struct TransferSensorEvents &event)
+{
+    size_t size = backlogSize_.load(std::memory_order_relaxed);
+    if (size == backlogCapacity_) {
+        backlogDroppedCount_.fetch_add(1, std::memory_order_relaxed);
+        if (backlogPolicy_ == BACKLOG_DROP_NEWEST) {
+            return;
+        }
+        if (backlogPolicy_ == BACKLOG_COALESCE_LATEST) {
+            // Replace the newest queued value of the same sensor, the per-sensor order stays intact
+            for (size_t i = size; i > 0; i--) {
+                auto &queued = backlog_[(backlogHead_ + i - 1) % backlogCapacity_];
+                if (queued.sensorTypeId == event.sensorTypeId) {
+                    queued = event;
+                    return;
+                }
+            }
+        }
+        backlogHead_ = (backlogHead_ + 1) % backlogCapacity_;
+        size--;
+    }
+    backlog_[(backlogHead_ + size) % backlogCapacity_] = event;
+    backlogSize_.store(size + 1, std::memory_order_relaxed);
+}
+
+void SensorBasicDataChannel::EnqueueBacklog(const struct TransferSensorEvents *events, size_t count)
+{
+    CHKPV(events);
+    std::lock_guard<std::mutex> backlogLock(backlogMutex_);
+    if (backlog_.size() != backlogCapacity_) {
+        // Only channels that ever fall behind pay for the backlog storage
+        backlog_.resize(backlogCapacity_);
+    }
+    for (size_t i = 0; i < count; i++) {
+        PushBacklog(events[i]);
+    }
+}
+
+int32_t SensorBasicDataChannel::FlushBacklog()
+{
+    std::lock_guard<std::mutex> backlogLock(backlogMutex_);
+    size_t size = backlogSize_.load(std::memory_order_relaxed);
+    while (size != 0) {
+        // The ring wraps at most once, send it as up to two contiguous runs
+        size_t runLength = std::min(size, backlogCapacity_ - backlogHead_);
+        size_t sentCount = 0;
+        int32_t ret = SendEventBatch(&backlog_[backlogHead_], runLength, sentCount);
+        backlogHead_ = (backlogHead_ + sentCount) % backlogCapacity_;
+        size -= sentCount;
+        backlogSize_.store(size, std::memory_order_relaxed);
+        if (ret != ERR_OK) {
+            return ret;
+        }
+    }
     return ERR_OK;
 }
 
-const std::unordered_map<uint32_t, struct SensorEvent> &SensorBasicDataChannel::GetDataCacheBuf() const
+ConsumerState SensorBasicDataChannel::GetConsumerState() const
+{
+    return static_cast<ConsumerState>(consumerState_.load(std::memory_order_relaxed));
+}
+
+ConsumerState SensorBasicDataChannel::UpdateConsumerState()
+{
+    std::lock_guard<std::mutex> backlogLock(backlogMutex_);
+    int64_t nowNs = GetSteadyTimeNs();
+    size_t size = backlogSize_.load(std::memory_order_relaxed);
+    if (size < backlogCapacity_) {
+        backlogFullSinceNs_ = 0;
+    } else if (backlogFullSinceNs_ == 0) {
+        backlogFullSinceNs_ = nowNs;
+    }
+    auto state = static_cast<ConsumerState>(consumerState_.load(std::memory_order_relaxed));
+    auto nextState = state;
+    switch (state) {
+        case CONSUMER_NORMAL:
+            if (size >= backlogCapacity_ / 2) {
+                nextState = CONSUMER_DEGRADED;
+            }
+            break;
+        case CONSUMER_DEGRADED:
+            if (backlogFullSinceNs_ != 0 && nowNs - backlogFullSinceNs_ >= CONSUMER_PAUSE_AFTER_NS) {
+                nextState = CONSUMER_PAUSED;
+            } else if (size == 0 && nowNs - stateSinceNs_ >= CONSUMER_STATE_HOLD_NS) {
+                nextState = CONSUMER_NORMAL;
+            }
+            break;
+        case CONSUMER_PAUSED:
+            // Resume through the degraded state, a client has to keep up for a while before it gets full rate
+            if (size == 0) {
+                nextState = CONSUMER_DEGRADED;
+            }
+            break;
+        default:
+            break;
+    }
+    if (nextState != state) {
+        SEN_HILOGW("consumer state : %{public}d -> %{public}d, backlog : %{public}zu", state, nextState, size);
+        if (nextState == CONSUMER_DEGRADED && state == CONSUMER_NORMAL) {
+            degradedCount_.fetch_add(1, std::memory_order_relaxed);
+        }
+        consumerState_.store(nextState, std::memory_order_relaxed);
+        stateSinceNs_ = nowNs;
+    }
+    return nextState;
+}
+
+void SensorBasicDataChannel::CountPausedDrop(size_t count)
+{
+    backlogDroppedCount_.fetch_add(count, std::memory_order_relaxed);
+}
+
+uint64_t SensorBasicDataChannel::GetDegradedCount() const
 {
-    return dataCacheBuf_;
+    return degradedCount_.load(std::memory_order_relaxed);
 }
 
 bool SensorBasicDataChannel::GetSensorStatus() const
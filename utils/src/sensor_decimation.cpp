@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sensor_decimation.h"
+
+namespace OHOS {
+namespace Sensors {
+bool SensorDecimation::IsSampleDue(int64_t &nextDueTimestamp, int64_t timestamp, int64_t samplingPeriodNs,
+    int64_t toleranceNs)
+{
+    if (samplingPeriodNs <= 0) {
+        return true;
+    }
+    // First sample, or the timestamp went backwards past the last delivered one, restart the schedule
+    if (nextDueTimestamp == 0 || timestamp < nextDueTimestamp - samplingPeriodNs) {
+        nextDueTimestamp = timestamp + samplingPeriodNs;
+        return true;
+    }
+    if (timestamp + toleranceNs < nextDueTimestamp) {
+        return false;
+    }
+    // Advance from the due time rather than the sample time so jitter does not accumulate into rate drift
+    nextDueTimestamp += samplingPeriodNs;
+    if (nextDueTimestamp + toleranceNs <= timestamp) {
+        // The stream had a gap, do not burst to catch up on missed periods
+        nextDueTimestamp = timestamp + samplingPeriodNs;
+    }
+    return true;
+}
+}  // namespace Sensors
+}  // namespace OHOS
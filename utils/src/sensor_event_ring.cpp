@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sensor_event_ring.h"
+
+#include <cinttypes>
+
+#include "securec.h"
+#include "sensors_errors.h"
+#include "sensors_log_domain.h"
+
+namespace OHOS {
+namespace Sensors {
+using namespace OHOS::HiviewDFX;
+
+namespace {
+constexpr HiLogLabel LABEL = { LOG_CORE, SensorsLogDomain::SENSOR_UTILS, "SensorEventRing" };
+constexpr uint32_t MIN_RING_CAPACITY = 2;
+constexpr uint32_t MAX_RING_CAPACITY = 1U << 16;
+
+uint32_t RoundUpPowerOfTwo(uint32_t value)
+{
+    uint32_t capacity = MIN_RING_CAPACITY;
+    while (capacity < value && capacity < MAX_RING_CAPACITY) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+}  // namespace
+
+SensorEventRing::SensorEventRing(uint32_t capacity, uint32_t payloadSize)
+    : capacity_(RoundUpPowerOfTwo(capacity)), mask_(capacity_ - 1)
+{
+    slots_ = new (std::nothrow) RingSlot[capacity_];
+    payloadSlab_ = new (std::nothrow) uint8_t[static_cast<size_t>(capacity_) * payloadSize];
+    if (slots_ == nullptr || payloadSlab_ == nullptr) {
+        SEN_HILOGE("alloc ring slots failed, capacity : %{public}u", capacity_);
+        delete[] slots_;
+        slots_ = nullptr;
+        delete[] payloadSlab_;
+        payloadSlab_ = nullptr;
+        capacity_ = 0;
+        mask_ = 0;
+        return;
+    }
+    for (uint32_t i = 0; i < capacity_; i++) {
+        slots_[i].event = {};
+        slots_[i].event.data = payloadSlab_ + static_cast<size_t>(i) * payloadSize;
+        slots_[i].payloadCapacity = payloadSize;
+        slots_[i].heapPayload = nullptr;
+    }
+}
+
+SensorEventRing::~SensorEventRing()
+{
+    if (slots_ != nullptr) {
+        for (uint32_t i = 0; i < capacity_; i++) {
+            delete[] slots_[i].heapPayload;
+        }
+        delete[] slots_;
+        slots_ = nullptr;
+    }
+    if (payloadSlab_ != nullptr) {
+        delete[] payloadSlab_;
+        payloadSlab_ = nullptr;
+    }
+}
+
+bool SensorEventRing::ReservePayload(RingSlot &slot, uint32_t dataLen)
+{
+    if (dataLen <= slot.payloadCapacity) {
+        return true;
+    }
+    // Oversized payloads grow this slot once, the buffer is kept for the next lap of the ring
+    uint8_t *payload = new (std::nothrow) uint8_t[dataLen];
+    if (payload == nullptr) {
+        SEN_HILOGE("alloc payload failed, dataLen : %{public}u", dataLen);
+        return false;
+    }
+    delete[] slot.heapPayload;
+    slot.heapPayload = payload;
+    slot.event.data = payload;
+    slot.payloadCapacity = dataLen;
+    uint64_t allocCount = payloadAllocCount_.fetch_add(1, std::memory_order_relaxed) + 1;
+    SEN_HILOGW("payload exceeds slab slot, dataLen : %{public}u, alloc count : %{public}" PRIu64, dataLen, allocCount);
+    return true;
+}
+
+bool SensorEventRing::WriteSlot(RingSlot &slot, const struct SensorEvent &event)
+{
+    if (!ReservePayload(slot, event.dataLen)) {
+        return false;
+    }
+    if (event.dataLen != 0 && memcpy_s(slot.event.data, slot.payloadCapacity, event.data, event.dataLen) != EOK) {
+        SEN_HILOGE("copy payload failed, dataLen : %{public}u", event.dataLen);
+        return false;
+    }
+    slot.event.sensorTypeId = event.sensorTypeId;
+    slot.event.version = event.version;
+    slot.event.timestamp = event.timestamp;
+    slot.event.option = event.option;
+    slot.event.mode = event.mode;
+    slot.event.dataLen = event.dataLen;
+    return true;
+}
+
+bool SensorEventRing::Push(const struct SensorEvent &event)
+{
+    return PushBatch(&event, 1) == 1;
+}
+
+uint32_t SensorEventRing::PushBatch(const struct SensorEvent *events, uint32_t count)
+{
+    if (events == nullptr || count == 0) {
+        return 0;
+    }
+    uint32_t writePos = writePos_.load(std::memory_order_relaxed);
+    if (capacity_ - (writePos - cachedReadPos_) < count) {
+        // Only touch the consumer's cache line when the cached view cannot hold the whole batch
+        cachedReadPos_ = readPos_.load(std::memory_order_acquire);
+    }
+    uint32_t freeSlots = capacity_ - (writePos - cachedReadPos_);
+    uint32_t pushCount = (count < freeSlots) ? count : freeSlots;
+    uint32_t written = 0;
+    for (uint32_t i = 0; i < pushCount; i++) {
+        if (WriteSlot(slots_[(writePos + written) & mask_], events[i])) {
+            written++;
+        }
+    }
+    if (written != count) {
+        droppedCount_.fetch_add(count - written, std::memory_order_relaxed);
+    }
+    if (written == 0) {
+        return 0;
+    }
+    // Publish the whole batch with a single store and wake the dispatcher at most once
+    writePos_.store(writePos + written, std::memory_order_release);
+    NotifyConsumer();
+    return written;
+}
+
+void SensorEventRing::NotifyConsumer()
+{
+    // Pairs with the fence in WaitForData, either the consumer sees the new data or we see it waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!consumerWaiting_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    std::lock_guard<std::mutex> waitLock(waitMutex_);
+    waitCondition_.notify_one();
+}
+
+uint32_t SensorEventRing::Available() const
+{
+    return writePos_.load(std::memory_order_acquire) - readPos_.load(std::memory_order_relaxed);
+}
+
+struct SensorEvent &SensorEventRing::At(uint32_t offset)
+{
+    return slots_[(readPos_.load(std::memory_order_relaxed) + offset) & mask_].event;
+}
+
+void SensorEventRing::Consume(uint32_t count)
+{
+    readPos_.store(readPos_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+}
+
+void SensorEventRing::WaitForData()
+{
+    if (Available() != 0) {
+        return;
+    }
+    std::unique_lock<std::mutex> waitLock(waitMutex_);
+    consumerWaiting_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    waitCondition_.wait(waitLock, [this] { return Available() != 0; });
+    consumerWaiting_.store(false, std::memory_order_relaxed);
+}
+
+uint32_t SensorEventRing::GetCapacity() const
+{
+    return capacity_;
+}
+
+uint64_t SensorEventRing::GetDroppedCount() const
+{
+    return droppedCount_.load(std::memory_order_relaxed);
+}
+
+uint64_t SensorEventRing::GetPayloadAllocCount() const
+{
+    return payloadAllocCount_.load(std::memory_order_relaxed);
+}
+}  // namespace Sensors
+}  // namespace OHOS
@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sensor_shared_ring.h"
+
+#include <cstddef>
+
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "sensors_errors.h"
+#include "sensors_log_domain.h"
+
+namespace OHOS {
+namespace Sensors {
+using namespace OHOS::HiviewDFX;
+
+namespace {
+constexpr HiLogLabel LABEL = { LOG_CORE, SensorsLogDomain::SENSOR_UTILS, "SensorSharedRing" };
+constexpr uint32_t SHARED_RING_MAGIC = 0x53525247;
+constexpr uint32_t SHARED_RING_VERSION = 1;
+constexpr uint32_t MIN_RING_CAPACITY = 2;
+constexpr uint32_t MAX_RING_CAPACITY = 1U << 14;
+// Leading uint32_t fields of RingHeader, read with pread before anything is mapped
+enum HeaderField : uint32_t {
+    HEADER_MAGIC = 0,
+    HEADER_VERSION = 1,
+    HEADER_CAPACITY = 2,
+    HEADER_SLOT_SIZE = 3,
+    HEADER_FIELD_COUNT = 4,
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared ring needs address-free 64-bit atomics");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared ring needs address-free 32-bit atomics");
+
+uint32_t RoundUpPowerOfTwo(uint32_t value)
+{
+    uint32_t capacity = MIN_RING_CAPACITY;
+    while (capacity < value && capacity < MAX_RING_CAPACITY) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+}  // namespace
+
+SensorSharedRing::~SensorSharedRing()
+{
+    Release();
+}
+
+int32_t SensorSharedRing::Create(uint32_t capacity)
+{
+    CALL_LOG_ENTER;
+    if (header_ != nullptr) {
+        SEN_HILOGD("shared ring already created");
+        return ERR_OK;
+    }
+    uint32_t ringCapacity = RoundUpPowerOfTwo(capacity);
+    size_t mapSize = sizeof(RingHeader) + static_cast<size_t>(ringCapacity) * sizeof(RingSlot);
+    memFd_ = memfd_create("sensor_shared_ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (memFd_ < 0) {
+        SEN_HILOGE("memfd_create failed, errno : %{public}d", errno);
+        return SENSOR_CHANNEL_SHARED_RING_CREATE_ERR;
+    }
+    if (ftruncate(memFd_, static_cast<off_t>(mapSize)) != 0) {
+        SEN_HILOGE("ftruncate failed, errno : %{public}d", errno);
+        Release();
+        return SENSOR_CHANNEL_SHARED_RING_CREATE_ERR;
+    }
+    // The service maps this file as well, sealing the size keeps a shrink from turning its writes into SIGBUS
+    if (fcntl(memFd_, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0) {
+        SEN_HILOGE("seal memfd failed, errno : %{public}d", errno);
+        Release();
+        return SENSOR_CHANNEL_SHARED_RING_CREATE_ERR;
+    }
+    if (Map(memFd_, mapSize) != ERR_OK) {
+        Release();
+        return SENSOR_CHANNEL_SHARED_RING_MAP_ERR;
+    }
+    eventFd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (eventFd_ < 0) {
+        SEN_HILOGE("eventfd failed, errno : %{public}d", errno);
+        Release();
+        return SENSOR_CHANNEL_SHARED_RING_CREATE_ERR;
+    }
+    header_->magic = SHARED_RING_MAGIC;
+    header_->version = SHARED_RING_VERSION;
+    header_->capacity = ringCapacity;
+    header_->slotSize = sizeof(RingSlot);
+    header_->writeCursor.store(0, std::memory_order_relaxed);
+    header_->waitingReaders.store(0, std::memory_order_relaxed);
+    capacity_ = ringCapacity;
+    mask_ = ringCapacity - 1;
+    SEN_HILOGI("create shared ring success, capacity : %{public}u, size : %{public}zu", capacity_, mapSize);
+    return ERR_OK;
+}
+
+int32_t SensorSharedRing::Attach(int32_t memFd, int32_t eventFd)
+{
+    CALL_LOG_ENTER;
+    memFd_ = memFd;
+    eventFd_ = eventFd;
+    if (memFd_ < 0 || eventFd_ < 0) {
+        SEN_HILOGE("invalid fd, memFd : %{public}d, eventFd : %{public}d", memFd_, eventFd_);
+        Release();
+        return SENSOR_CHANNEL_SHARED_RING_MAP_ERR;
+    }
+    int32_t seals = fcntl(memFd_, F_GET_SEALS);
+    if (seals < 0 || (static_cast<uint32_t>(seals) & F_SEAL_SHRINK) == 0) {
+        SEN_HILOGE("memfd is not sealed against shrinking, seals : %{public}d", seals);
+        Release();
+        return SENSOR_CHANNEL_SHARED_RING_MAP_ERR;
+    }
+    static_assert(offsetof(RingHeader, slotSize) == HEADER_SLOT_SIZE * sizeof(uint32_t), "unexpected header layout");
+    // The header lives in client writable memory, validate a private copy before sizing the mapping from it
+    uint32_t headerFields[HEADER_FIELD_COUNT] = {};
+    if (pread(memFd_, headerFields, sizeof(headerFields), 0) != static_cast<ssize_t>(sizeof(headerFields))) {
+        SEN_HILOGE("read shared ring header failed, errno : %{public}d", errno);
+        Release();
+        return SENSOR_CHANNEL_SHARED_RING_MAP_ERR;
+    }
+    uint32_t capacity = headerFields[HEADER_CAPACITY];
+    if (headerFields[HEADER_MAGIC] != SHARED_RING_MAGIC || headerFields[HEADER_VERSION] != SHARED_RING_VERSION ||
+        headerFields[HEADER_SLOT_SIZE] != sizeof(RingSlot) || capacity < MIN_RING_CAPACITY ||
+        capacity > MAX_RING_CAPACITY || (capacity & (capacity - 1)) != 0) {
+        SEN_HILOGE("invalid shared ring header, capacity : %{public}u", capacity);
+        Release();
+        return SENSOR_CHANNEL_SHARED_RING_MAP_ERR;
+    }
+    size_t mapSize = sizeof(RingHeader) + static_cast<size_t>(capacity) * sizeof(RingSlot);
+    struct stat memStat = {};
+    if (fstat(memFd_, &memStat) != 0 || memStat.st_size != static_cast<off_t>(mapSize)) {
+        SEN_HILOGE("memfd size does not match capacity : %{public}u", capacity);
+        Release();
+        return SENSOR_CHANNEL_SHARED_RING_MAP_ERR;
+    }
+    if (Map(memFd_, mapSize) != ERR_OK) {
+        Release();
+        return SENSOR_CHANNEL_SHARED_RING_MAP_ERR;
+    }
+    capacity_ = capacity;
+    mask_ = capacity - 1;
+    writeCursor_ = header_->writeCursor.load(std::memory_order_relaxed);
+    // The mapping stays valid once the fd is closed, only the wakeup fd is needed from here on
+    close(memFd_);
+    memFd_ = -1;
+    return ERR_OK;
+}
+
+int32_t SensorSharedRing::Map(int32_t memFd, size_t mapSize)
+{
+    void *addr = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, memFd, 0);
+    if (addr == MAP_FAILED) {
+        SEN_HILOGE("mmap failed, errno : %{public}d", errno);
+        return SENSOR_CHANNEL_SHARED_RING_MAP_ERR;
+    }
+    mapAddr_ = addr;
+    mapSize_ = mapSize;
+    header_ = static_cast<RingHeader *>(addr);
+    slots_ = reinterpret_cast<RingSlot *>(static_cast<uint8_t *>(addr) + sizeof(RingHeader));
+    return ERR_OK;
+}
+
+void SensorSharedRing::Release()
+{
+    if (mapAddr_ != nullptr) {
+        munmap(mapAddr_, mapSize_);
+        mapAddr_ = nullptr;
+        mapSize_ = 0;
+    }
+    header_ = nullptr;
+    slots_ = nullptr;
+    capacity_ = 0;
+    mask_ = 0;
+    if (memFd_ >= 0) {
+        close(memFd_);
+        memFd_ = -1;
+    }
+    if (eventFd_ >= 0) {
+        close(eventFd_);
+        eventFd_ = -1;
+    }
+}
+
+int32_t SensorSharedRing::GetMemFd() const
+{
+    return memFd_;
+}
+
+int32_t SensorSharedRing::GetEventFd() const
+{
+    return eventFd_;
+}
+
+int32_t SensorSharedRing::Write(const struct TransferSensorEvents *events, uint32_t count)
+{
+    CHKPR(events, SENSOR_CHANNEL_SEND_ADDR_ERR);
+    std::lock_guard<std::mutex> writeLock(writeMutex_);
+    if (header_ == nullptr) {
+        SEN_HILOGE("shared ring is not mapped");
+        return SENSOR_CHANNEL_BASIC_CHANNEL_NOT_INIT;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        RingSlot &slot = slots_[writeCursor_ & mask_];
+        // A zero sequence marks the slot as being rewritten, readers that raced with us drop their copy
+        slot.sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.event = events[i];
+        slot.sequence.store(writeCursor_ + 1, std::memory_order_release);
+        writeCursor_++;
+    }
+    header_->writeCursor.store(writeCursor_, std::memory_order_release);
+    // Pairs with BeginWait, either the reader sees the new cursor or we see it waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (header_->waitingReaders.load(std::memory_order_relaxed) != 0) {
+        eventfd_write(eventFd_, 1);
+    }
+    return ERR_OK;
+}
+
+uint64_t SensorSharedRing::GetWriteCursor() const
+{
+    CHKPR(header_, 0);
+    return header_->writeCursor.load(std::memory_order_acquire);
+}
+
+uint32_t SensorSharedRing::Read(uint64_t &cursor, struct TransferSensorEvents *events, uint32_t maxCount,
+    uint64_t &lostCount) const
+{
+    CHKPR(events, 0);
+    if (header_ == nullptr) {
+        return 0;
+    }
+    uint64_t writeCursor = header_->writeCursor.load(std::memory_order_acquire);
+    uint32_t count = 0;
+    while (count < maxCount && cursor < writeCursor) {
+        if (writeCursor - cursor > capacity_) {
+            // The writer lapped this reader, resume from the oldest slot that is still intact
+            lostCount += writeCursor - capacity_ - cursor;
+            cursor = writeCursor - capacity_;
+        }
+        const RingSlot &slot = slots_[cursor & mask_];
+        uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence == cursor + 1) {
+            events[count] = slot.event;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == sequence) {
+                count++;
+                cursor++;
+                continue;
+            }
+        }
+        // The slot was rewritten under us, refresh the writer position and skip what was lost
+        writeCursor = header_->writeCursor.load(std::memory_order_acquire);
+        if (writeCursor - cursor <= capacity_) {
+            lostCount++;
+            cursor++;
+        }
+    }
+    return count;
+}
+
+void SensorSharedRing::BeginWait()
+{
+    CHKPV(header_);
+    header_->waitingReaders.fetch_add(1, std::memory_order_seq_cst);
+}
+
+void SensorSharedRing::EndWait()
+{
+    CHKPV(header_);
+    header_->waitingReaders.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+void SensorSharedRing::ClearWakeup() const
+{
+    if (eventFd_ < 0) {
+        return;
+    }
+    eventfd_t value = 0;
+    eventfd_read(eventFd_, &value);
+}
+}  // namespace Sensors
+}  // namespace OHOS
@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sensor_wire_format.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "securec.h"
+#include "sensors_errors.h"
+#include "sensors_log_domain.h"
+
+namespace OHOS {
+namespace Sensors {
+using namespace OHOS::HiviewDFX;
+
+namespace {
+constexpr HiLogLabel LABEL = { LOG_CORE, SensorsLogDomain::SENSOR_UTILS, "SensorWireFormat" };
+constexpr size_t COMPACT_RECORD_ALIGN = sizeof(int64_t);
+constexpr size_t MAX_AXIS_COUNT = SENSOR_MAX_LENGTH / sizeof(float);
+// Matches the events a client takes per datagram, a block never has to be split on the receiving side
+constexpr size_t MAX_DELTA_COUNT = 99;
+// Keeps quantized levels far from int32 overflow when the steps are summed up again
+constexpr double MAX_DELTA_LEVEL = 1 << 30;
+static_assert(sizeof(CompactEventHeader) % COMPACT_RECORD_ALIGN == 0, "compact header breaks record alignment");
+
+size_t AlignRecordSize(size_t size)
+{
+    return (size + COMPACT_RECORD_ALIGN - 1) & ~(COMPACT_RECORD_ALIGN - 1);
+}
+
+size_t GetDeltaRecordSize(size_t dataLen, size_t deltaCount)
+{
+    size_t axisCount = dataLen / sizeof(float);
+    return AlignRecordSize(sizeof(CompactEventHeader) + dataLen + sizeof(DeltaBlockHeader) +
+        deltaCount * (sizeof(uint32_t) + axisCount * sizeof(int16_t)));
+}
+
+bool IsSameStream(const struct TransferSensorEvents &keyframe, const struct TransferSensorEvents &event)
+{
+    return event.sensorTypeId == keyframe.sensorTypeId && event.dataLen == keyframe.dataLen &&
+        event.version == keyframe.version && event.option == keyframe.option && event.mode == keyframe.mode;
+}
+
+bool WriteHeader(const struct TransferSensorEvents &event, uint32_t encoding, uint8_t *buffer, size_t size)
+{
+    CompactEventHeader header = {
+        .timestamp = event.timestamp,
+        .sensorTypeId = event.sensorTypeId,
+        .version = event.version,
+        .option = event.option,
+        .mode = event.mode,
+        .dataLen = static_cast<uint32_t>(std::min(static_cast<size_t>(event.dataLen), sizeof(event.data))),
+        .encoding = encoding
+    };
+    if (memcpy_s(buffer, size, &header, sizeof(header)) != EOK) {
+        SEN_HILOGE("copy compact header failed");
+        return false;
+    }
+    if (header.dataLen != 0 &&
+        memcpy_s(buffer + sizeof(header), size - sizeof(header), event.data, header.dataLen) != EOK) {
+        SEN_HILOGE("copy compact payload failed");
+        return false;
+    }
+    return true;
+}
+
+bool ClearPadding(uint8_t *buffer, size_t length, size_t recordSize)
+{
+    // Padding goes out on the socket as well, keep stale bytes of the scratch buffer out of the client
+    if (recordSize > length && memset_s(buffer + length, recordSize - length, 0, recordSize - length) != EOK) {
+        SEN_HILOGE("clear compact padding failed");
+        return false;
+    }
+    return true;
+}
+
+size_t DecodeDeltaBlock(const CompactEventHeader &header, const uint8_t *payload, size_t length,
+    struct TransferSensorEvents *events, size_t maxCount, size_t &recordSize)
+{
+    size_t axisCount = header.dataLen / sizeof(float);
+    DeltaBlockHeader block;
+    if (header.dataLen == 0 || header.dataLen > SENSOR_MAX_LENGTH || (header.dataLen % sizeof(float)) != 0 ||
+        length < header.dataLen + sizeof(block) ||
+        memcpy_s(&block, sizeof(block), payload + header.dataLen, sizeof(block)) != EOK) {
+        SEN_HILOGE("invalid delta block, dataLen : %{public}u", header.dataLen);
+        return 0;
+    }
+    recordSize = GetDeltaRecordSize(header.dataLen, block.deltaCount);
+    if (block.deltaCount > MAX_DELTA_COUNT || block.deltaCount >= maxCount || !std::isfinite(block.quantum) ||
+        block.quantum <= 0.0f || recordSize > sizeof(header) + length) {
+        SEN_HILOGE("invalid delta block, deltaCount : %{public}u", block.deltaCount);
+        return 0;
+    }
+    uint32_t timestampSteps[MAX_DELTA_COUNT];
+    int16_t levelSteps[MAX_DELTA_COUNT * MAX_AXIS_COUNT];
+    float base[MAX_AXIS_COUNT];
+    const uint8_t *cursor = payload + header.dataLen + sizeof(block);
+    size_t timestampSize = block.deltaCount * sizeof(uint32_t);
+    size_t levelSize = block.deltaCount * axisCount * sizeof(int16_t);
+    if (memcpy_s(base, sizeof(base), payload, header.dataLen) != EOK ||
+        (timestampSize != 0 && memcpy_s(timestampSteps, sizeof(timestampSteps), cursor, timestampSize) != EOK) ||
+        (levelSize != 0 && memcpy_s(levelSteps, sizeof(levelSteps), cursor + timestampSize, levelSize) != EOK)) {
+        SEN_HILOGE("copy delta block failed");
+        return 0;
+    }
+    struct TransferSensorEvents &keyframe = events[0];
+    keyframe.sensorTypeId = header.sensorTypeId;
+    keyframe.version = header.version;
+    keyframe.timestamp = header.timestamp;
+    keyframe.option = header.option;
+    keyframe.mode = header.mode;
+    keyframe.dataLen = header.dataLen;
+    if (memcpy_s(keyframe.data, sizeof(keyframe.data), base, header.dataLen) != EOK) {
+        SEN_HILOGE("copy keyframe failed");
+        return 0;
+    }
+    int32_t levels[MAX_AXIS_COUNT] = {};
+    float values[MAX_AXIS_COUNT];
+    for (size_t i = 0; i < block.deltaCount; i++) {
+        // Axes are independent, both inner loops have no cross-iteration dependency and are vectorized
+        const int16_t *steps = levelSteps + i * axisCount;
+        for (size_t axis = 0; axis < axisCount; axis++) {
+            levels[axis] += steps[axis];
+        }
+        for (size_t axis = 0; axis < axisCount; axis++) {
+            values[axis] = base[axis] + block.quantum * static_cast<float>(levels[axis]);
+        }
+        struct TransferSensorEvents &event = events[i + 1];
+        event = keyframe;
+        event.timestamp = events[i].timestamp + static_cast<int64_t>(timestampSteps[i]);
+        if (memcpy_s(event.data, sizeof(event.data), values, header.dataLen) != EOK) {
+            SEN_HILOGE("copy delta event failed");
+            return i + 1;
+        }
+    }
+    return block.deltaCount + 1;
+}
+}  // namespace
+
+size_t SensorWireFormat::GetCompactEventSize(const struct TransferSensorEvents &event)
+{
+    size_t dataLen = std::min(static_cast<size_t>(event.dataLen), sizeof(event.data));
+    return AlignRecordSize(sizeof(CompactEventHeader) + dataLen);
+}
+
+size_t SensorWireFormat::EncodeCompactEvent(const struct TransferSensorEvents &event, uint8_t *buffer, size_t size)
+{
+    CHKPR(buffer, 0);
+    size_t recordSize = GetCompactEventSize(event);
+    if (recordSize > size || !WriteHeader(event, COMPACT_ENCODING_RAW, buffer, size)) {
+        return 0;
+    }
+    size_t length = sizeof(CompactEventHeader) + std::min(static_cast<size_t>(event.dataLen), sizeof(event.data));
+    if (!ClearPadding(buffer, length, recordSize)) {
+        return 0;
+    }
+    return recordSize;
+}
+
+size_t SensorWireFormat::EncodeDeltaBlock(const struct TransferSensorEvents *events, size_t count, float quantum,
+    uint8_t *buffer, size_t size, size_t &encodedCount)
+{
+    encodedCount = 0;
+    CHKPR(events, 0);
+    CHKPR(buffer, 0);
+    const struct TransferSensorEvents &keyframe = events[0];
+    if (count < 2 || !std::isfinite(quantum) || quantum <= 0.0f || keyframe.dataLen == 0 ||
+        keyframe.dataLen > SENSOR_MAX_LENGTH || (keyframe.dataLen % sizeof(float)) != 0) {
+        return 0;
+    }
+    size_t axisCount = keyframe.dataLen / sizeof(float);
+    float base[MAX_AXIS_COUNT];
+    if (memcpy_s(base, sizeof(base), keyframe.data, keyframe.dataLen) != EOK) {
+        SEN_HILOGE("copy keyframe failed");
+        return 0;
+    }
+    uint32_t timestampSteps[MAX_DELTA_COUNT];
+    int16_t levelSteps[MAX_DELTA_COUNT * MAX_AXIS_COUNT];
+    int32_t levels[MAX_AXIS_COUNT] = {};
+    size_t deltaCount = 0;
+    size_t maxDeltaCount = std::min(count - 1, MAX_DELTA_COUNT);
+    // The block ends at the first event that does not fit, it goes out as the keyframe of the next record
+    while (deltaCount < maxDeltaCount) {
+        const struct TransferSensorEvents &event = events[deltaCount + 1];
+        int64_t timestampStep = event.timestamp - events[deltaCount].timestamp;
+        if (!IsSameStream(keyframe, event) || timestampStep < 0 ||
+            timestampStep > static_cast<int64_t>(std::numeric_limits<uint32_t>::max()) ||
+            GetDeltaRecordSize(keyframe.dataLen, deltaCount + 1) > size) {
+            break;
+        }
+        float values[MAX_AXIS_COUNT];
+        if (memcpy_s(values, sizeof(values), event.data, event.dataLen) != EOK) {
+            break;
+        }
+        int32_t nextLevels[MAX_AXIS_COUNT];
+        bool isEncodable = true;
+        for (size_t axis = 0; axis < axisCount && isEncodable; axis++) {
+            double level = std::round((static_cast<double>(values[axis]) - base[axis]) / quantum);
+            isEncodable = std::isfinite(level) && std::fabs(level) <= MAX_DELTA_LEVEL;
+            nextLevels[axis] = isEncodable ? static_cast<int32_t>(level) : 0;
+            int32_t step = nextLevels[axis] - levels[axis];
+            isEncodable = isEncodable && step >= std::numeric_limits<int16_t>::min() &&
+                step <= std::numeric_limits<int16_t>::max();
+        }
+        if (!isEncodable) {
+            break;
+        }
+        for (size_t axis = 0; axis < axisCount; axis++) {
+            levelSteps[deltaCount * axisCount + axis] = static_cast<int16_t>(nextLevels[axis] - levels[axis]);
+            levels[axis] = nextLevels[axis];
+        }
+        timestampSteps[deltaCount] = static_cast<uint32_t>(timestampStep);
+        deltaCount++;
+    }
+    if (deltaCount == 0) {
+        return 0;
+    }
+    size_t recordSize = GetDeltaRecordSize(keyframe.dataLen, deltaCount);
+    if (!WriteHeader(keyframe, COMPACT_ENCODING_DELTA, buffer, size)) {
+        return 0;
+    }
+    DeltaBlockHeader block = {
+        .deltaCount = static_cast<uint32_t>(deltaCount),
+        .quantum = quantum
+    };
+    size_t length = sizeof(CompactEventHeader) + keyframe.dataLen;
+    size_t timestampSize = deltaCount * sizeof(uint32_t);
+    size_t levelSize = deltaCount * axisCount * sizeof(int16_t);
+    if (memcpy_s(buffer + length, size - length, &block, sizeof(block)) != EOK ||
+        memcpy_s(buffer + length + sizeof(block), size - length - sizeof(block), timestampSteps,
+            timestampSize) != EOK ||
+        memcpy_s(buffer + length + sizeof(block) + timestampSize, size - length - sizeof(block) - timestampSize,
+            levelSteps, levelSize) != EOK) {
+        SEN_HILOGE("copy delta block failed");
+        return 0;
+    }
+    if (!ClearPadding(buffer, length + sizeof(block) + timestampSize + levelSize, recordSize)) {
+        return 0;
+    }
+    encodedCount = deltaCount + 1;
+    return recordSize;
+}
+
+size_t SensorWireFormat::DecodeCompactEvents(const uint8_t *buffer, size_t length,
+    struct TransferSensorEvents *events, size_t maxCount)
+{
+    CHKPR(buffer, 0);
+    CHKPR(events, 0);
+    size_t count = 0;
+    size_t offset = 0;
+    while (count < maxCount && length - offset >= sizeof(CompactEventHeader)) {
+        CompactEventHeader header;
+        if (memcpy_s(&header, sizeof(header), buffer + offset, sizeof(header)) != EOK) {
+            SEN_HILOGE("copy compact header failed");
+            break;
+        }
+        const uint8_t *payload = buffer + offset + sizeof(header);
+        size_t payloadLength = length - offset - sizeof(header);
+        size_t recordSize = 0;
+        if (header.encoding == COMPACT_ENCODING_DELTA) {
+            size_t num = DecodeDeltaBlock(header, payload, payloadLength, events + count, maxCount - count,
+                recordSize);
+            if (num == 0) {
+                break;
+            }
+            offset += recordSize;
+            count += num;
+            continue;
+        }
+        recordSize = AlignRecordSize(sizeof(header) + header.dataLen);
+        if (header.encoding != COMPACT_ENCODING_RAW || header.dataLen > SENSOR_MAX_LENGTH ||
+            recordSize > length - offset) {
+            SEN_HILOGE("invalid compact record, encoding : %{public}u, dataLen : %{public}u, left : %{public}zu",
+                header.encoding, header.dataLen, length - offset);
+            break;
+        }
+        struct TransferSensorEvents &event = events[count];
+        event.sensorTypeId = header.sensorTypeId;
+        event.version = header.version;
+        event.timestamp = header.timestamp;
+        event.option = header.option;
+        event.mode = header.mode;
+        event.dataLen = header.dataLen;
+        if (header.dataLen != 0 && memcpy_s(event.data, sizeof(event.data), payload, header.dataLen) != EOK) {
+            SEN_HILOGE("copy compact payload failed");
+            break;
+        }
+        offset += recordSize;
+        count++;
+    }
+    return count;
+}
+}  // namespace Sensors
+}  // namespace OHOS